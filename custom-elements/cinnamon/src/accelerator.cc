@@ -1,6 +1,7 @@
 // Copyright (c) Siddharth Jayashankar. All rights reserved.
 #include <cmath>
 #include <queue>
+#include <random>
 
 #include "sst/core/component.h"
 #include "sst/core/event.h"
@@ -74,16 +75,80 @@ CinnamonAccelerator::CinnamonAccelerator(ComponentId_t id, Params &params) : Com
         chips.push_back(std::move(chip));
     }
 
+    configureSymmetry(params);
+
     output->verbose(CALL_INFO, 2, 0, "Cinnamon configuration completed successfully.\n");
 }
 
+void CinnamonAccelerator::configureSymmetry(Params &params) {
+    representative.resize(numChips);
+    for (size_t chipID = 0; chipID < numChips; chipID++) {
+        representative[chipID] = chipID;
+    }
+    numChipClasses = numChips;
+
+    auto symmetry = params.find<std::string>("symmetry", "none");
+    if (symmetry != "none") {
+        std::vector<uint64_t> chipClass(numChips);
+        if (symmetry == "auto") {
+            // Chips whose traces only differ in term and register names are equivalent
+            for (size_t chipID = 0; chipID < numChips; chipID++) {
+                chipClass[chipID] = chips[chipID]->traceFingerprint();
+            }
+        } else if (symmetry == "manual") {
+            params.find_array<uint64_t>("chip_classes", chipClass);
+            if (chipClass.size() != numChips) {
+                output->fatal(CALL_INFO, -1, "chip_classes has %zu entries, expected one per chip (%zu)\n", chipClass.size(), numChips);
+            }
+        } else {
+            output->fatal(CALL_INFO, -1, "Unknown symmetry mode: %s\n", symmetry.c_str());
+        }
+
+        // The lowest chip ID of each class is its representative
+        std::map<uint64_t, size_t> classRepresentative;
+        std::vector<size_t> replayedChips;
+        for (size_t chipID = 0; chipID < numChips; chipID++) {
+            auto it = classRepresentative.emplace(chipClass[chipID], chipID).first;
+            representative[chipID] = it->second;
+            if (it->second != chipID) {
+                replayedChips.push_back(chipID);
+            }
+        }
+        numChipClasses = classRepresentative.size();
+
+        if (params.find<bool>("symmetry_validate", false) && !replayedChips.empty()) {
+            std::mt19937_64 rng(params.find<uint64_t>("symmetry_seed", 1));
+            std::uniform_int_distribution<size_t> pick(0, replayedChips.size() - 1);
+            validationChip = replayedChips[pick(rng)];
+            validationReference = representative[validationChip.value()];
+            representative[validationChip.value()] = validationChip.value();
+        }
+
+        for (size_t chipID = 0; chipID < numChips; chipID++) {
+            if (representative[chipID] != chipID) {
+                network->addShadowChip(representative[chipID], chipID);
+                chips[chipID]->setReplayedFrom(chips[representative[chipID]].get());
+            }
+        }
+        output->verbose(CALL_INFO, 1, 0, "Symmetry reduction: %zu chips in %zu classes\n", numChips, numChipClasses);
+    }
+
+    for (size_t chipID = 0; chipID < numChips; chipID++) {
+        if (representative[chipID] == chipID) {
+            detailedChips.push_back(chips[chipID].get());
+        }
+    }
+}
+
 void CinnamonAccelerator::init(unsigned int phase) {
+    network->init(phase);
     for (auto &chip : chips) {
         chip->init(phase);
     }
 }
 
 void CinnamonAccelerator::setup() {
+    network->setup();
     for (auto &chip : chips) {
         chip->setup();
     }
@@ -93,18 +158,36 @@ void CinnamonAccelerator::finish() {
     for (auto &chip : chips) {
         chip->finish();
     }
+    network->finish();
     output->output("------------------------------------------------------------------------\n");
     output->output("%s", network->printStats().c_str());
     output->output("------------------------------------------------------------------------\n");
+    if (detailedChips.size() != numChips) {
+        std::stringstream s;
+        s << "Symmetry Reduction: \n";
+        s << "\tChip Classes: " << numChipClasses << "\n";
+        s << "\tChips Simulated: " << detailedChips.size() << "\n";
+        s << "\tChips Replayed: " << numChips - detailedChips.size() << "\n";
+        if (validationChip) {
+            auto validated = chips[validationChip.value()]->completionCycle();
+            auto reference = chips[validationReference]->completionCycle();
+            double deviation = validated ? (100.0 * std::abs(static_cast<double>(validated) - static_cast<double>(reference))) / validated : 0.0;
+            s << "\tValidation Chip: " << validationChip.value() << " (Representative: " << validationReference << ")\n";
+            s << "\tValidation Completion Cycle: " << validated << "\n";
+            s << "\tRepresentative Completion Cycle: " << reference << "\n";
+            s << "\tDeviation %: " << deviation << "\n";
+        }
+        output->output("%s", s.str().c_str());
+        output->output("------------------------------------------------------------------------\n");
+    }
     output->output("Finished \n");
 }
 
 bool CinnamonAccelerator::tick(SST::Cycle_t cycle) {
     bool retval = true;
-    for (auto &chip : chips) {
+    for (auto chip : detailedChips) {
         retval &= chip->tick(cycle);
     }
-    network->tick(cycle);
     if (retval) {
         primaryComponentOKToEndSim();
         return true;
@@ -2,6 +2,7 @@
 #ifndef CINNAMONCPU_H
 #define CINNAMONCPU_H
 
+#include <optional>
 #include <queue>
 
 #include "sst/core/component.h"
@@ -64,6 +65,12 @@ public:
         {"numPhysicalVecRegs", "Sets number of physical vector registers", "10"},
         {"vecRegSize", "Sets size of a vector register", "10"},
 
+        // Symmetry reduction
+        {"symmetry", "Simulate one representative chip per class of equivalent chips: none, auto (compare trace structure) or manual (use chip_classes)", "none"},
+        {"chip_classes", "Array with the equivalence class label of each chip. Used when symmetry is manual", ""},
+        {"symmetry_validate", "Also simulate one randomly chosen replayed chip in full detail and report its deviation", "false"},
+        {"symmetry_seed", "Seed used to pick the validation chip", "1"},
+
     )
 
     SST_ELI_DOCUMENT_PORTS(
@@ -84,6 +91,17 @@ private:
 
     size_t numChips;
     std::vector<std::unique_ptr<CinnamonChip>> chips;
+
+    // Chips that are ticked. With symmetry reduction the remaining chips replay a representative
+    std::vector<CinnamonChip *> detailedChips;
+    // Representative whose timing each chip takes. A chip is its own representative when simulated in detail
+    std::vector<size_t> representative;
+    size_t numChipClasses;
+    // Replayed chip that is simulated in detail to validate the symmetry assumption
+    std::optional<size_t> validationChip;
+    size_t validationReference;
+
+    void configureSymmetry(Params &params);
     std::shared_ptr<SST::Output> output;
 
     std::unique_ptr<CinnamonNetwork> network;
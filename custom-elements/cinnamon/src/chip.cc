@@ -7,6 +7,7 @@
 #include "functionalUnit.h"
 #include "memoryUnit.h"
 #include <algorithm>
+#include <set>
 
 namespace SST {
 namespace Cinnamon {
@@ -34,6 +35,28 @@ CinnamonChip::CinnamonChip(ComponentId_t id, Params &params, CinnamonAccelerator
 
     output->verbose(CALL_INFO, 2, 0, "Use PRNG: %s\n", config.usePRNG ? "true" : "false");
 
+    if (params.find<bool>("memoize", false)) {
+        auto blockSize = params.find<size_t>("memoBlockSize", 256);
+        if (blockSize == 0) {
+            output->fatal(CALL_INFO, -1, "%s, Fatal: memoBlockSize must be non-zero\n", getName().c_str());
+        }
+        double verifyRate = 0.0;
+        if (params.find<bool>("memoStrict", false)) {
+            verifyRate = params.find<double>("memoVerifyRate", 0.05);
+        }
+        memoizer = std::make_unique<CinnamonTimingMemoizer>(blockSize, verifyRate, params.find<uint64_t>("memoSeed", 1));
+        output->verbose(CALL_INFO, 2, 0, "Timing memoization enabled. Block Size: %zu\n", blockSize);
+    }
+
+    limbGroupLimit = params.find<uint16_t>("limbGroupSize", 1);
+    if (limbGroupLimit == 0) {
+        output->fatal(CALL_INFO, -1, "%s, Fatal: limbGroupSize must be non-zero\n", getName().c_str());
+    }
+    referenceCycles = params.find<SST::Cycle_t>("referenceCycles", 0);
+    fastForwardToRoi = params.find<bool>("fastForwardToRoi", false);
+    outsideRoi = fastForwardToRoi;
+    limbGroup = std::make_unique<CinnamonLimbGroupQueue>();
+
     reader.reset(loadUserSubComponent<CinnamonTraceReader>("reader",
                                                            ComponentInfo::SHARE_NONE,
                                                            output));
@@ -56,8 +79,81 @@ CinnamonChip::CinnamonChip(ComponentId_t id, Params &params, CinnamonAccelerator
         output->fatal(CALL_INFO, -1, "Unable to load memoryInterface subcomponent\n");
     }
 
-    auto requestWidth = params.find<size_t>("memoryRequestWidth", 1024);
-    memoryUnit = std::make_unique<CinnamonMemoryUnit>(this, accelerator, output_level, memory, requestWidth);
+    CinnamonMemoryUnit::Config memoryConfig;
+    memoryConfig.requestWidth = params.find<size_t>("memoryRequestWidth", 1024);
+    memoryConfig.numMSHRs = params.find<size_t>("numMSHRs", 2);
+    memoryConfig.maxOutstandingLoads = params.find<size_t>("maxOutstandingLoads", memoryConfig.numMSHRs);
+    memoryConfig.maxOutstandingStores = params.find<size_t>("maxOutstandingStores", memoryConfig.numMSHRs);
+    memoryConfig.inOrderCompletion = params.find<bool>("inOrderMemoryCompletion", false);
+    auto transferMode = params.find<std::string>("memoryTransferMode", "request");
+    if (transferMode == "bulk") {
+        memoryConfig.bulkTransfers = true;
+        memoryConfig.bulkTransferSize = params.find<size_t>("bulkTransferSize", 0);
+    } else if (transferMode != "request") {
+        output->fatal(CALL_INFO, -1, "%s, Fatal: Unknown memoryTransferMode %s. Expected request or bulk\n", getName().c_str(), transferMode.c_str());
+    }
+    try {
+        memoryConfig.arbitration = CinnamonMemoryUnit::parseArbitration(params.find<std::string>("memoryArbitration", "loadsFirst"));
+    } catch (const std::invalid_argument &e) {
+        output->fatal(CALL_INFO, -1, "%s, Fatal: %s\n", getName().c_str(), e.what());
+    }
+    memoryConfig.loadQueueCapacity = params.find<size_t>("loadQueueCapacity", 0);
+    memoryConfig.storeQueueCapacity = params.find<size_t>("storeQueueCapacity", 0);
+    memoryConfig.scalarQueueCapacity = params.find<size_t>("scalarQueueCapacity", 0);
+    memoryConfig.storeQueueWatermark = params.find<size_t>("storeQueueWatermark", 8);
+    memoryConfig.freeRegisterWatermark = params.find<size_t>("freeRegisterWatermark", 16);
+    memoryConfig.spillDeferLimit = params.find<SST::Cycle_t>("spillDeferLimit", 10000);
+    prefetchWindow = params.find<size_t>("prefetchWindow", 0);
+    if (prefetchWindow > 0) {
+        memoryConfig.prefetchBufferSize = params.find<size_t>("prefetchBufferSize", 16);
+    }
+    auto scratchpadCapacity = params.find<size_t>("scratchpadCapacity", 0);
+    if (scratchpadCapacity > 0) {
+        try {
+            auto policy = CinnamonScratchpad::parsePolicy(params.find<std::string>("scratchpadPolicy", "lru"));
+            scratchpad = std::make_unique<CinnamonScratchpad>(scratchpadCapacity,
+                                                              params.find<size_t>("scratchpadBanks", 8),
+                                                              limbBytes,
+                                                              params.find<size_t>("scratchpadBankWidth", 1024),
+                                                              policy);
+        } catch (const std::invalid_argument &e) {
+            output->fatal(CALL_INFO, -1, "%s, Fatal: %s\n", getName().c_str(), e.what());
+        }
+    }
+    scratchpadLookahead = params.find<size_t>("scratchpadLookahead", 10000);
+    modelScalarLoads = params.find<bool>("modelScalarLoads", true);
+    memoryConfig.scalarBurstSize = params.find<size_t>("scalarBurstSize", 4 * scalarBytes);
+    auto scalarCacheCapacity = params.find<size_t>("scalarCacheCapacity", 0);
+    if (modelScalarLoads && scalarCacheCapacity > 0) {
+        try {
+            auto policy = CinnamonScratchpad::parsePolicy(params.find<std::string>("scalarCachePolicy", "lru"));
+            scalarCache = std::make_unique<CinnamonScratchpad>(scalarCacheCapacity, 1,
+                                                               scalarBytes,
+                                                               params.find<size_t>("scalarCacheBankWidth", 1024),
+                                                               policy);
+        } catch (const std::invalid_argument &e) {
+            output->fatal(CALL_INFO, -1, "%s, Fatal: %s\n", getName().c_str(), e.what());
+        }
+    }
+    try {
+        auto placement = CinnamonTermAllocator::parsePlacement(params.find<std::string>("termPlacement", "sequential"));
+        termAllocator = std::make_unique<CinnamonTermAllocator>(placement,
+                                                                limbBytes,
+                                                                params.find<size_t>("placementChannels", 8),
+                                                                params.find<size_t>("placementBanks", 16),
+                                                                params.find<size_t>("placementInterleaveSize", 256));
+        scalarAllocator = std::make_unique<CinnamonTermAllocator>(CinnamonTermAllocator::Placement::Sequential,
+                                                                  scalarBytes,
+                                                                  1, 1, 1,
+                                                                  1ULL << 40);
+    } catch (const std::invalid_argument &e) {
+        output->fatal(CALL_INFO, -1, "%s, Fatal: %s\n", getName().c_str(), e.what());
+    }
+    reclaimFreedTerms = params.find<bool>("reclaimFreedTerms", true);
+    if (memoryConfig.numMSHRs == 0 || memoryConfig.maxOutstandingLoads == 0 || memoryConfig.maxOutstandingStores == 0) {
+        output->fatal(CALL_INFO, -1, "%s, Fatal: numMSHRs, maxOutstandingLoads and maxOutstandingStores must be non-zero\n", getName().c_str());
+    }
+    memoryUnit = std::make_unique<CinnamonMemoryUnit>(this, accelerator, output_level, memory, memoryConfig);
     // functionalUnit = std::make_unique<CinnamonFunctionalUnit>(this,output_level,2);
     std::vector<std::shared_ptr<CinnamonFunctionalUnit>> addUnits;
     for (int i = 0; i < numAddUnits; i++) {
@@ -148,7 +244,51 @@ CinnamonChip::CinnamonChip(ComponentId_t id, Params &params, CinnamonAccelerator
 
     modQueue = std::make_unique<CinnamonModQueue>(this, "modQueue", output_level, latency, modUnits);
 
-    disQueue = std::make_unique<CinnamonDisQueue>(this, accelerator, "disQueue", output_level, network, networkLink);
+    syncPayloadBytes = params.find<uint64_t>("syncPayloadBytes", syncPayloadBytes);
+    syncScalarPayloadBytes = params.find<uint64_t>("syncScalarPayloadBytes", syncScalarPayloadBytes);
+    std::vector<std::string> payloadEntries;
+    params.find_array<std::string>("syncPayloadBytesPerOpcode", payloadEntries);
+    for (auto &entry : payloadEntries) {
+        static const std::map<std::string, CinnamonInstructionOpCode> networkOpCodes = {
+            {"dis", CinnamonInstructionOpCode::Dis},
+            {"rcv", CinnamonInstructionOpCode::Rcv},
+            {"joi", CinnamonInstructionOpCode::Joi},
+            {"agt", CinnamonInstructionOpCode::Agt},
+            {"rsc", CinnamonInstructionOpCode::Rsc},
+            {"ata", CinnamonInstructionOpCode::Ata}};
+        auto colon = entry.find(':');
+        auto opCode = networkOpCodes.find(entry.substr(0, colon));
+        if (colon == std::string::npos || opCode == networkOpCodes.end()) {
+            output->fatal(CALL_INFO, -1, "%s, Fatal: Malformed syncPayloadBytesPerOpcode entry %s. Expected opcode:bytes with opcode one of dis, rcv, joi, agt, rsc or ata\n", getName().c_str(), entry.c_str());
+        }
+        auto bytes = std::stoull(entry.substr(colon + 1));
+        if (bytes == 0) {
+            output->fatal(CALL_INFO, -1, "%s, Fatal: syncPayloadBytesPerOpcode entry %s must give a non-zero size\n", getName().c_str(), entry.c_str());
+        }
+        syncPayloadPerOpcode[opCode->second] = bytes;
+    }
+    if (syncPayloadBytes == 0 || syncScalarPayloadBytes == 0) {
+        output->fatal(CALL_INFO, -1, "%s, Fatal: syncPayloadBytes and syncScalarPayloadBytes must be non-zero\n", getName().c_str());
+    }
+
+    CinnamonDisQueue::Config disConfig;
+    disConfig.maxOutstanding = params.find<size_t>("maxOutstandingSyncs", 1);
+    disConfig.injectionWidth = params.find<uint64_t>("networkInjectionWidth", 0);
+    disConfig.ejectionWidth = params.find<uint64_t>("networkEjectionWidth", 0);
+    if (disConfig.maxOutstanding == 0) {
+        output->fatal(CALL_INFO, -1, "%s, Fatal: maxOutstandingSyncs must be non-zero\n", getName().c_str());
+    }
+    if (params.find<bool>("streamingReceive", false)) {
+        disConfig.streamChunkBytes = params.find<uint64_t>("streamChunkBytes", 1024);
+        if (disConfig.streamChunkBytes == 0) {
+            output->fatal(CALL_INFO, -1, "%s, Fatal: streamChunkBytes must be non-zero\n", getName().c_str());
+        }
+        if (disConfig.ejectionWidth == 0) {
+            output->fatal(CALL_INFO, -1, "%s, Fatal: streamingReceive needs a non-zero networkEjectionWidth\n", getName().c_str());
+        }
+    }
+    disQueue = std::make_unique<CinnamonDisQueue>(this, accelerator, "disQueue", output_level, network, networkLink, disConfig);
+    fastForwardQueue = std::make_unique<CinnamonFastForwardQueue>(this, "fastForwardQueue", output_level);
 
     for (int i = 0; i < numVectorRegs; i++) {
         auto vreg = std::make_shared<PhysicalRegister>(this, PhysicalRegister::PhysicalRegister_t::Vector, i);
@@ -168,9 +308,34 @@ CinnamonChip::CinnamonChip(ComponentId_t id, Params &params, CinnamonAccelerator
         freeBaseConversionVirtualRegisters.push(i);
     }
 
+    if (params.find<bool>("sampling", false)) {
+        if (memoizer) {
+            output->fatal(CALL_INFO, -1, "%s, Fatal: Sampling and timing memoization cannot be combined\n", getName().c_str());
+        }
+        std::vector<std::string> unitNames;
+        for (auto &fu : functionalUnits) {
+            unitNames.push_back(fu->getName());
+        }
+        sampler = std::make_unique<CinnamonSamplingController>(params.find<uint64_t>("samplingDetailedLength", 1000),
+                                                               params.find<uint64_t>("samplingFastForwardLength", 97000),
+                                                               params.find<uint64_t>("samplingWarmupLength", 2000),
+                                                               params.find<double>("samplingTargetError", 0.02),
+                                                               params.find<double>("samplingConfidenceZ", 1.96),
+                                                               unitNames);
+        sampler->begin(activitySnapshot(0));
+    }
+
     output->verbose(CALL_INFO, 2, 0, "Cinnamon configuration completed successfully.\n");
 }
 
+void CinnamonChip::recordStreamedStart(SST::Cycle_t savedCycles) {
+    disQueue->recordStreamedStart(savedCycles);
+}
+
+void CinnamonChip::releaseMemoryInstruction(const CinnamonMemoryInstruction &instruction) {
+    memoryUnit->release(instruction);
+}
+
 void CinnamonChip::handleResponse(Interfaces::StandardMem::Request *response_ptr) {
     memoryUnit->handleResponse(response_ptr);
 }
@@ -192,6 +357,8 @@ void CinnamonChip::setup() {
 
 void CinnamonChip::finish() {
     const uint64_t nanoSeconds = accelerator->getCurrentSimTimeNano();
+    // Replayed chips report the statistics of the chip they were replayed from
+    const CinnamonChip &source = replayedFrom ? *replayedFrom : *this;
 
     output->output("\n");
     output->output("------------------------------------------------------------------------\n");
@@ -199,22 +366,110 @@ void CinnamonChip::finish() {
 
     output->output("------------------------------------------------------------------------\n");
     output->output("- Completed at:                          %" PRIu64 " ns\n", nanoSeconds);
+    if (replayedFrom) {
+        output->output("- Timing replayed from:                  Chip %" PRIu32 "\n", replayedFrom->chipID());
+    }
     output->output("------------------------------------------------------------------------\n");
-    output->output("%s", memoryUnit->printStats().c_str());
+    output->output("%s", source.memoryUnit->printStats().c_str());
     output->output("------------------------------------------------------------------------\n");
-    for (auto &fu : functionalUnits) {
+    for (auto &fu : source.functionalUnits) {
         output->output("%s", fu->printStats().c_str());
         output->output("- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - \n");
     }
+    output->output("%s", source.disQueue->printStats().c_str());
+    output->output("- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - \n");
     std::stringstream s;
     s << "Register File:\n";
-    s << "\tVector Register Reads : " << stats_.vectorRegisterReads << "\n";
-    s << "\tVector Register Writes: " << stats_.vectorRegisterWrites << "\n";
+    s << "\tVector Register Reads : " << source.stats_.vectorRegisterReads << "\n";
+    s << "\tVector Register Writes: " << source.stats_.vectorRegisterWrites << "\n";
     output->output("- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - \n");
     output->output("%s", s.str().c_str());
+    if (source.roiBegin) {
+        std::stringstream r;
+        r << "Region of Interest:\n";
+        r << "\tBegin Cycle: " << source.roiBegin->cycle << "\n";
+        r << "\tInstructions Before Region: " << source.roiBeginInstruction << "\n";
+        if (source.roiEnd) {
+            auto delta = *(source.roiEnd) - *(source.roiBegin);
+            SST::Cycle_t fuBusy = 0;
+            for (auto busy : delta.fuBusyCycles) {
+                fuBusy += busy;
+            }
+            r << "\tEnd Cycle: " << source.roiEnd->cycle << "\n";
+            r << "\tRegion Cycles: " << delta.cycle << "\n";
+            r << "\tRegion Instructions: " << source.roiEndInstruction - source.roiBeginInstruction << "\n";
+            r << "\tRegion Loads: " << delta.memoryLoads << "\n";
+            r << "\tRegion Stores: " << delta.memoryStores << "\n";
+            r << "\tRegion Memory Busy Cycles: " << delta.memoryBusyCycles << "\n";
+            r << "\tRegion Functional Unit Busy Cycles: " << fuBusy << "\n";
+        } else {
+            r << "\tRegion Cycles: " << source.completionCycle_ - source.roiBegin->cycle << " (no roi_end, region runs to the end of the trace)\n";
+        }
+        output->output("- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - \n");
+        output->output("%s", r.str().c_str());
+    } else if (source.fastForwardToRoi) {
+        output->output("- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - \n");
+        output->output("Region of Interest: no roi_begin marker found. The whole trace was fast-forwarded\n");
+    }
+    if (source.limbGroupLimit > 1) {
+        std::stringstream c;
+        c << "Limb Group Coarsening:\n";
+        c << "\tMax Group Size: " << source.limbGroupLimit << "\n";
+        c << "\tMacro Instructions: " << source.stats_.macroInstructions << "\n";
+        c << "\tCoarsened Instructions: " << source.stats_.coarsenedInstructions << "\n";
+        double avgGroup = source.stats_.macroInstructions ? double(source.stats_.coarsenedInstructions) / source.stats_.macroInstructions : 0.0;
+        c << "\tAverage Group Size: " << avgGroup << "\n";
+        if (source.referenceCycles != 0) {
+            // Error against a full detail run of the same trace
+            double error = (100.0 * (double(source.completionCycle_) - double(source.referenceCycles))) / source.referenceCycles;
+            c << "\tCompletion Cycle: " << source.completionCycle_ << "\n";
+            c << "\tReference Cycles: " << source.referenceCycles << "\n";
+            c << "\tError vs Reference %: " << error << "\n";
+        }
+        output->output("- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - \n");
+        output->output("%s", c.str().c_str());
+    }
+    output->output("- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - \n");
+    output->output("%s", source.termAllocator->printStats("Term Allocator").c_str());
+    output->output("%s", source.scalarAllocator->printStats("Scalar Term Allocator").c_str());
+    if (source.scratchpad) {
+        output->output("- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - \n");
+        output->output("%s", source.scratchpad->printStats("Scratchpad").c_str());
+    }
+    if (source.scalarCache) {
+        output->output("- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - \n");
+        output->output("%s", source.scalarCache->printStats("Scalar Cache").c_str());
+    }
+    if (source.sampler) {
+        output->output("- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - \n");
+        output->output("%s", source.sampler->printStats().c_str());
+    }
+    if (source.memoizer) {
+        output->output("- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - \n");
+        output->output("%s", source.memoizer->printStats().c_str());
+    }
     output->output("------------------------------------------------------------------------\n");
 }
 
+std::shared_ptr<CinnamonParsedInstruction> CinnamonChip::fetchInstruction() {
+    if (lookahead.empty()) {
+        return reader->readNextInstruction(0);
+    }
+    auto instruction = lookahead.front();
+    lookahead.pop_front();
+    return instruction;
+}
+
+std::shared_ptr<CinnamonParsedInstruction> CinnamonChip::peekInstruction(size_t n) {
+    while (lookahead.size() <= n) {
+        if (!lookahead.empty() && lookahead.back() == nullptr) {
+            return nullptr;
+        }
+        lookahead.push_back(reader->readNextInstruction(0));
+    }
+    return lookahead.at(n);
+}
+
 bool CinnamonChip::canMapToPhysicalRegister(const CinnamonParsedValueType &val) {
 
     bool mappable = false;
@@ -254,6 +509,7 @@ std::shared_ptr<PhysicalRegister> CinnamonChip::mapToPhysicalRegister(const Cinn
                               mappedRegister = vectorRegisters.at(vectorRegisterRenameMap.at(arg.id));
                               // mappedRegister->setMapped(arg.id);
                               mappedRegister->incReference();
+                              mappedRegister->clearConsumers();
                               stats_.vectorRegisterWrites++;
                           },
                           [&](const CinnamonParsedScalarReg &arg) {
@@ -269,6 +525,7 @@ std::shared_ptr<PhysicalRegister> CinnamonChip::mapToPhysicalRegister(const Cinn
                               mappedRegister = scalarRegisters.at(scalarRegisterRenameMap.at(arg.id));
                               // mappedRegister->setMapped(arg.id);
                               mappedRegister->incReference();
+                              mappedRegister->clearConsumers();
                           }},
                val);
     // mappedRegister->incReference();
@@ -296,6 +553,10 @@ std::shared_ptr<PhysicalRegister> CinnamonChip::getMappedPhysicalRegister(const
                               }
                           }},
                val);
+    // Every caller reads the register
+    if (mappedRegister) {
+        mappedRegister->addConsumer();
+    }
     return mappedRegister;
 }
 
@@ -333,54 +594,321 @@ std::shared_ptr<BaseConversionRegister> CinnamonChip::getMappedBaseConversionVir
     return mappedRegister;
 }
 
+CinnamonInstructionQueue *CinnamonChip::route(const std::unique_ptr<CinnamonInstructionQueue> &queue) {
+    if (fastForwarding()) {
+        return fastForwardQueue.get();
+    }
+    if (limbGroupOpen) {
+        limbGroup->setTarget(queue.get());
+        return limbGroup.get();
+    }
+    return queue.get();
+}
+
+void CinnamonChip::enqueueMemoryInstruction(const std::shared_ptr<CinnamonMemoryInstruction> &instruction) {
+    using OpCode = CinnamonInstructionOpCode;
+    if (fastForwarding()) {
+        memoryUnit->hold(*instruction);
+        fastForwardQueue->addToInstructionQueue(instruction);
+    } else if (limbGroupOpen) {
+        memoryUnit->hold(*instruction);
+        limbGroup->addToInstructionQueue(instruction);
+    } else if (instruction->getOpCode() == OpCode::LoadV) {
+        memoryUnit->addToLoadQueue(instruction);
+    } else if (instruction->getOpCode() == OpCode::LoadS) {
+        memoryUnit->addToScalarQueue(instruction);
+    } else {
+        memoryUnit->addToStoreQueue(instruction);
+    }
+}
+
+// Number of instructions starting at the fetched instruction that can be issued as one macro-instruction
+size_t CinnamonChip::formLimbGroup() {
+    using OpCode = CinnamonInstructionOpCode;
+
+    auto op = fetchedInstruction->opCode;
+    switch (op) {
+    case OpCode::Add:
+    case OpCode::Sub:
+    case OpCode::Mul:
+    case OpCode::Neg:
+    case OpCode::LoadV:
+    case OpCode::Store:
+        break;
+    default:
+        return 1;
+    }
+
+    // Every member except stores may need a free register. Limiting the group to the free registers
+    // guarantees that an open group never stalls dispatch
+    size_t limit = limbGroupLimit;
+    if (op != OpCode::Store) {
+        limit = std::min(limit, freeVectorRegisters.size());
+    }
+    if (memoizer) {
+        limit = std::min(limit, memoBlockRemaining);
+    }
+    if (sampler) {
+        limit = std::min<size_t>(limit, sampler->remaining());
+    }
+
+    auto vectorRegIDs = [](const std::vector<CinnamonParsedValueType> &values) {
+        std::vector<std::uint16_t> ids;
+        for (auto &val : values) {
+            if (auto reg = std::get_if<CinnamonParsedVectorReg>(&val)) {
+                ids.push_back(reg->id);
+            }
+        }
+        return ids;
+    };
+
+    std::set<std::uint16_t> limbs{fetchedInstruction->baseIndex};
+    auto destIDs = vectorRegIDs(fetchedInstruction->dests);
+    std::set<std::uint16_t> groupDests(destIDs.begin(), destIDs.end());
+    size_t size = 1;
+    for (; size < limit; size++) {
+        auto next = peekInstruction(size - 1);
+        if (next == nullptr || next->opCode != op || limbs.count(next->baseIndex) != 0) {
+            break;
+        }
+        // Members must be independent of each other
+        bool dependent = false;
+        for (auto id : vectorRegIDs(next->srcs)) {
+            dependent = dependent || groupDests.count(id) != 0;
+        }
+        auto nextDests = vectorRegIDs(next->dests);
+        for (auto id : nextDests) {
+            dependent = dependent || groupDests.count(id) != 0;
+        }
+        if (dependent) {
+            break;
+        }
+        limbs.insert(next->baseIndex);
+        groupDests.insert(nextDests.begin(), nextDests.end());
+    }
+    return size;
+}
+
+void CinnamonChip::closeLimbGroup() {
+    using OpCode = CinnamonInstructionOpCode;
+
+    limbGroupOpen = false;
+    auto target = limbGroup->getTarget();
+    auto members = limbGroup->release();
+    if (members.empty()) {
+        return; // All loads of the group were served by aliasing instructions
+    }
+    stats_.macroInstructions++;
+    stats_.coarsenedInstructions += members.size();
+
+    auto op = members.front()->getOpCode();
+    if (op == OpCode::LoadV || op == OpCode::Store) {
+        auto leader = std::static_pointer_cast<CinnamonMemoryInstruction>(members.front());
+        for (size_t i = 1; i < members.size(); i++) {
+            leader->merge(std::static_pointer_cast<CinnamonMemoryInstruction>(members.at(i)));
+        }
+        // The memory unit queue keeps the limbs busy from here on
+        enqueueMemoryInstruction(leader);
+        memoryUnit->release(*leader);
+    } else if (members.size() == 1) {
+        target->addToInstructionQueue(members.front());
+    } else {
+        target->addToInstructionQueue(std::make_shared<CinnamonMacroInstruction>(members));
+    }
+}
+
+SST::Interfaces::StandardMem::Addr CinnamonChip::termAddress(const std::string &term, uint16_t limbIndex, SST::Cycle_t currentCycle, bool scalar) {
+    auto it = termToAddressMap.find(term);
+    if (it != termToAddressMap.end()) {
+        return it->second;
+    }
+    auto &allocator = scalar ? scalarAllocator : termAllocator;
+    auto addr = allocator->allocate(limbIndex, [&](SST::Interfaces::StandardMem::Addr freed) {
+        return memoryUnit->idle(freed);
+    });
+    termToAddressMap[term] = addr;
+    output->verbose(CALL_INFO, 3, 0, "%s: [Time: %lu] Mapping Term %s to Address : %" PRIx64 "\n", getName().c_str(), currentCycle, term.c_str(), addr);
+    return addr;
+}
+
+void CinnamonChip::freeTerm(const CinnamonParsedInstruction &instruction, SST::Cycle_t currentCycle) {
+    using OpCode = CinnamonInstructionOpCode;
+    if (!reclaimFreedTerms || (instruction.opCode != OpCode::LoadV && instruction.opCode != OpCode::LoadS)) {
+        return;
+    }
+    auto &term = std::get<CinnamonParsedTerm>(instruction.srcs.at(0));
+    if (!term.free_from_mem) {
+        return;
+    }
+    auto it = termToAddressMap.find(term.term);
+    assert(it != termToAddressMap.end());
+    auto addr = it->second;
+    termToAddressMap.erase(it);
+    // Buffered copies of the term are dead
+    if (instruction.opCode == OpCode::LoadS) {
+        if (scalarCache) {
+            scalarCache->invalidate(addr);
+        }
+        scalarAllocator->free(addr);
+    } else {
+        memoryUnit->invalidatePrefetch(addr);
+        if (scratchpad) {
+            scratchpad->invalidate(addr);
+        }
+        termAllocator->free(addr);
+    }
+    output->verbose(CALL_INFO, 3, 0, "%s: [Time: %lu] Freeing Term %s at Address : %" PRIx64 "\n", getName().c_str(), currentCycle, term.term.c_str(), addr);
+}
+
+bool CinnamonChip::loadsFromMemory(const CinnamonParsedInstruction &instruction) const {
+    using OpCode = CinnamonInstructionOpCode;
+    return instruction.opCode == OpCode::LoadV || (instruction.opCode == OpCode::EvkGen && !config.usePRNG);
+}
+
+std::unordered_map<SST::Interfaces::StandardMem::Addr, size_t> CinnamonChip::upcomingLoads() {
+    std::unordered_map<SST::Interfaces::StandardMem::Addr, size_t> distances;
+    for (size_t i = 0; i < scratchpadLookahead; i++) {
+        auto instruction = peekInstruction(i);
+        if (instruction == nullptr) {
+            break;
+        }
+        if (!loadsFromMemory(*instruction) && instruction->opCode != CinnamonInstructionOpCode::LoadS) {
+            continue;
+        }
+        auto term = std::get_if<CinnamonParsedTerm>(&instruction->srcs.at(0));
+        // Terms without an address have never been loaded and cannot be resident
+        auto it = term ? termToAddressMap.find(term->term) : termToAddressMap.end();
+        if (it != termToAddressMap.end()) {
+            distances.emplace(it->second, i + 1);
+        }
+    }
+    return distances;
+}
+
+void CinnamonChip::prefetchLookahead() {
+    using OpCode = CinnamonInstructionOpCode;
+    // Instructions enter the window once. A load that finds the prefetch buffer full is scanned again next cycle
+    for (; prefetchScanned < prefetchWindow; prefetchScanned++) {
+        auto instruction = (prefetchScanned == 0) ? fetchedInstruction : peekInstruction(prefetchScanned - 1);
+        if (instruction == nullptr) {
+            break;
+        }
+        auto op = instruction->opCode;
+        bool load = loadsFromMemory(*instruction);
+        if (!load && op != OpCode::Store && op != OpCode::Spill) {
+            continue;
+        }
+        auto term = std::get_if<CinnamonParsedTerm>(&instruction->srcs.at(0));
+        if (term == nullptr) {
+            continue;
+        }
+        if (!load) {
+            prefetchWindowStores[term->term]++;
+            continue;
+        }
+        if (prefetchWindowStores.count(term->term)) {
+            continue; // The load will be forwarded from the store
+        }
+        // Terms without an address have never been stored or loaded. Their address is assigned at dispatch
+        auto it = termToAddressMap.find(term->term);
+        if (it == termToAddressMap.end()) {
+            continue;
+        }
+        auto addr = it->second;
+        if (memoryUnit->hasStoreAlias(addr) || memoryUnit->hasLoadAlias(addr) || (scratchpad && scratchpad->contains(addr))) {
+            continue;
+        }
+        if (!memoryUnit->prefetch(addr, limbBytes)) {
+            break; // Prefetch buffer is full
+        }
+    }
+}
+
+void CinnamonChip::leavePrefetchWindow(const CinnamonParsedInstruction &instruction) {
+    using OpCode = CinnamonInstructionOpCode;
+    if (prefetchScanned == 0) {
+        return;
+    }
+    prefetchScanned--;
+    if (instruction.opCode != OpCode::Store && instruction.opCode != OpCode::Spill) {
+        return;
+    }
+    auto term = std::get_if<CinnamonParsedTerm>(&instruction.srcs.at(0));
+    if (term == nullptr) {
+        return;
+    }
+    auto it = prefetchWindowStores.find(term->term);
+    assert(it != prefetchWindowStores.end());
+    if (--it->second == 0) {
+        prefetchWindowStores.erase(it);
+    }
+}
+
+bool CinnamonChip::readCached(CinnamonScratchpad &cache, const std::shared_ptr<CinnamonMemoryInstruction> &instruction, SST::Cycle_t currentCycle) {
+    auto hit = cache.read(instruction->getAddr(), currentCycle);
+    if (hit) {
+        memoryUnit->addLocalRead(instruction, hit->readyCycle, hit->fill);
+        output->verbose(CALL_INFO, 3, 0, "%s: %lu Dispatching Instruction to on-chip cache: %s\n", getName().c_str(), currentCycle, instruction->getString().c_str());
+        return true;
+    }
+    std::optional<std::unordered_map<SST::Interfaces::StandardMem::Addr, size_t>> distances;
+    cache.allocate(instruction, [&](SST::Interfaces::StandardMem::Addr limb) {
+        if (!distances) {
+            distances = upcomingLoads();
+        }
+        auto it = distances->find(limb);
+        return it == distances->end() ? SIZE_MAX : it->second;
+    });
+    return false;
+}
+
 bool CinnamonChip::dispatchMemoryInstruction(SST::Cycle_t currentCycle, const std::shared_ptr<CinnamonParsedInstruction> &instruction) {
     using OpCode = CinnamonInstructionOpCode;
 
-    std::size_t limbSize = (64 * 1024 * 28) / 8; // 224 KB
-    std::size_t scalarSize = (2048 * 28) / 8;    // 7KB
     auto &dests = instruction->dests;
     std::shared_ptr<PhysicalRegister> destReg = nullptr;
     assert(dests.size() == 1);
     auto &op = instruction->opCode;
     std::size_t size = 0;
 
-    SST::Interfaces::StandardMem::Addr addr = 0;
     auto &srcs = instruction->srcs;
     assert(srcs.size() == 1);
     auto term = std::get<CinnamonParsedTerm>(srcs[0]);
-    auto it = termToAddressMap.find(term.term);
-    if (it == termToAddressMap.end()) {
-        addr = numTerms;
-        addr *= limbSize;
-        termToAddressMap[term.term] = addr;
-        output->verbose(CALL_INFO, 3, 0, "%s: [Time: %lu] Mapping Term %s to Address : %" PRIx64 "\n", getName().c_str(), currentCycle, term.term.c_str(), addr);
-        numTerms++;
-    } else {
-        addr = it->second;
+    SST::Interfaces::StandardMem::Addr addr = termAddress(term.term, instruction->baseIndex, currentCycle, op == OpCode::LoadS);
+
+    // Fast-forwarded instructions do not occupy the memory queues
+    if ((op == OpCode::Store || op == OpCode::Spill) && memoryUnit->storeQueueFull() && !fastForwarding()) {
+        memoryUnit->recordDispatchStall(false);
+        return false;
     }
-    // if(term.free_from_mem){
-    // 	termToAddressMap.erase(term.term);
-    // }
 
     if (op == OpCode::Store) {
         auto aliasPhyReg = memoryUnit->findStoreAlias(addr, true /* Quash aliasing store since it is being overwritten */);
+        memoryUnit->invalidatePrefetch(addr);
+        if (scratchpad) {
+            scratchpad->invalidate(addr);
+        }
         destReg = getMappedPhysicalRegister(dests[0]);
         destReg->incReference();
-        size = limbSize;
+        size = limbBytes;
         auto dispatchInstruction = std::make_shared<CinnamonMemoryInstruction>(op, destReg, addr, size);
-        memoryUnit->addToStoreQueue(dispatchInstruction);
+        enqueueMemoryInstruction(dispatchInstruction);
         output->verbose(CALL_INFO, 3, 0, "%s: %lu Dispatching Instruction: %s\n", getName().c_str(), currentCycle, dispatchInstruction->getString().c_str());
     } else if (op == OpCode::Spill) {
         auto aliasPhyReg = memoryUnit->findStoreAlias(addr, false /* Don't quash aliasing store since this spill itself might get quashed. However quash aliasing spills */);
+        memoryUnit->invalidatePrefetch(addr);
+        if (scratchpad) {
+            scratchpad->invalidate(addr);
+        }
         destReg = getMappedPhysicalRegister(dests[0]);
         destReg->incReference();
-        size = limbSize;
+        size = limbBytes;
         auto dispatchInstruction = std::make_shared<CinnamonMemoryInstruction>(op, destReg, addr, size);
-        memoryUnit->addToStoreQueue(dispatchInstruction);
+        enqueueMemoryInstruction(dispatchInstruction);
         output->verbose(CALL_INFO, 3, 0, "%s: %lu Dispatching Instruction: %s\n", getName().c_str(), currentCycle, dispatchInstruction->getString().c_str());
     } else if (op == OpCode::LoadV) {
         auto aliasPhyReg = memoryUnit->findStoreAlias(addr, false /*Don't quash pending stores. Only spills will be quashed */);
-        size = limbSize;
+        size = limbBytes;
         if (aliasPhyReg != nullptr) {
             auto arg = std::get<CinnamonParsedVectorReg>(dests[0]);
             auto it = vectorRegisterRenameMap.find(arg.id);
@@ -392,6 +920,7 @@ bool CinnamonChip::dispatchMemoryInstruction(SST::Cycle_t currentCycle, const st
             vectorRegisterRenameMap[arg.id] = aliasPhyReg->getID();
             destReg = aliasPhyReg;
             destReg->incReference();
+            memoryUnit->invalidatePrefetch(addr); // Forwarded from the store
             return true;
         }
         aliasPhyReg = memoryUnit->findLoadAlias(addr);
@@ -406,15 +935,31 @@ bool CinnamonChip::dispatchMemoryInstruction(SST::Cycle_t currentCycle, const st
             destReg = aliasPhyReg;
             destReg->incReference();
             // destReg->setMapped();
+            memoryUnit->invalidatePrefetch(addr); // Forwarded from the queued load
             return true;
         }
+        bool servedOnChip = memoryUnit->prefetched(addr) || (scratchpad && scratchpad->contains(addr));
+        if (memoryUnit->loadQueueFull() && !servedOnChip && !fastForwarding()) {
+            memoryUnit->recordDispatchStall(true);
+            return false;
+        }
         if (canMapToPhysicalRegister(dests[0]) == false) {
             return false;
         }
         destReg = mapToPhysicalRegister(dests[0]);
         destReg->incReference();
         auto dispatchInstruction = std::make_shared<CinnamonMemoryInstruction>(op, destReg, addr, size);
-        memoryUnit->addToLoadQueue(dispatchInstruction);
+        if (scratchpad && !fastForwarding() && readCached(*scratchpad, dispatchInstruction, currentCycle)) {
+            memoryUnit->invalidatePrefetch(addr);
+            return true;
+        }
+        if (fastForwarding()) {
+            // Completed functionally, so it must not wait on a timed prefetch
+            memoryUnit->invalidatePrefetch(addr);
+            enqueueMemoryInstruction(dispatchInstruction);
+        } else if (!memoryUnit->claimPrefetch(dispatchInstruction)) {
+            enqueueMemoryInstruction(dispatchInstruction);
+        }
         output->verbose(CALL_INFO, 3, 0, "%s: %lu Dispatching Instruction: %s\n", getName().c_str(), currentCycle, dispatchInstruction->getString().c_str());
     } else if (op == OpCode::LoadS) {
 
@@ -434,19 +979,27 @@ bool CinnamonChip::dispatchMemoryInstruction(SST::Cycle_t currentCycle, const st
         // if(freeScalarRegisters.size() < 1){
         // 	return false;
         // }
+        bool servedOnChip = !modelScalarLoads || (scalarCache && scalarCache->contains(addr));
+        if (memoryUnit->scalarQueueFull() && !servedOnChip && !fastForwarding()) {
+            memoryUnit->recordScalarDispatchStall();
+            return false;
+        }
         if (canMapToPhysicalRegister(dests[0]) == false) {
             return false;
         }
         destReg = mapToPhysicalRegister(dests[0]);
         destReg->incReference();
-        size = scalarSize;
+        size = scalarBytes;
         auto dispatchInstruction = std::make_shared<CinnamonMemoryInstruction>(op, destReg, addr, size);
-
-        // Scalar loads don't take any time
-        dispatchInstruction->setExecutionComplete();
-        // memoryUnit->addToLoadQueue(dispatchInstruction);
-        // output->verbose(CALL_INFO, 3, 0, "%s: %lu Dispatching Instruction: %s\n", getName().c_str(), currentCycle, dispatchInstruction->getString().c_str() );
-        // return true;
+        if (!modelScalarLoads) {
+            dispatchInstruction->setExecutionComplete();
+            return true;
+        }
+        if (scalarCache && !fastForwarding() && readCached(*scalarCache, dispatchInstruction, currentCycle)) {
+            return true;
+        }
+        enqueueMemoryInstruction(dispatchInstruction);
+        output->verbose(CALL_INFO, 3, 0, "%s: %lu Dispatching Instruction: %s\n", getName().c_str(), currentCycle, dispatchInstruction->getString().c_str());
     }
 
     return true;
@@ -485,10 +1038,10 @@ bool CinnamonChip::dispatchBinOpInstruction(SST::Cycle_t currentCycle, const std
     switch (op) {
     case OpCode::Add:
     case OpCode::Sub:
-        addQueue->addToInstructionQueue(dispatchInstruction);
+        route(addQueue)->addToInstructionQueue(dispatchInstruction);
         break;
     case OpCode::Mul:
-        mulQueue->addToInstructionQueue(dispatchInstruction);
+        route(mulQueue)->addToInstructionQueue(dispatchInstruction);
         break;
     }
 
@@ -533,14 +1086,14 @@ bool CinnamonChip::dispatchUnOpInstruction(SST::Cycle_t currentCycle, const std:
     // functionalUnit->addToQueue(dispatchInstruction);
     switch (op) {
     case OpCode::Int:
-        nttQueue->addToInstructionQueue(dispatchInstruction);
+        route(nttQueue)->addToInstructionQueue(dispatchInstruction);
         break;
     case OpCode::Neg:
-        addQueue->addToInstructionQueue(dispatchInstruction);
+        route(addQueue)->addToInstructionQueue(dispatchInstruction);
         break;
     case OpCode::Rot:
     case OpCode::Con:
-        rotQueue->addToInstructionQueue(dispatchInstruction);
+        route(rotQueue)->addToInstructionQueue(dispatchInstruction);
         break;
     }
 
@@ -573,7 +1126,7 @@ bool CinnamonChip::dispatchEvgInstruction(SST::Cycle_t currentCycle, const std::
     // functionalUnit->addToQueue(dispatchInstruction);
     switch (op) {
     case OpCode::EvkGen:
-        evgQueue->addToInstructionQueue(dispatchInstruction);
+        route(evgQueue)->addToInstructionQueue(dispatchInstruction);
         break;
     }
 
@@ -620,7 +1173,7 @@ bool CinnamonChip::dispatchNttInstruction(SST::Cycle_t currentCycle, const std::
                srcs[0]);
     switch (op) {
     case OpCode::Ntt:
-        nttQueue->addToInstructionQueue(dispatchInstruction);
+        route(nttQueue)->addToInstructionQueue(dispatchInstruction);
         break;
     }
 
@@ -670,7 +1223,7 @@ bool CinnamonChip::dispatchSuDInstruction(SST::Cycle_t currentCycle, const std::
                srcs[1]);
     switch (op) {
     case OpCode::SuD:
-        sudQueue->addToInstructionQueue(dispatchInstruction);
+        route(sudQueue)->addToInstructionQueue(dispatchInstruction);
         break;
     }
 
@@ -699,7 +1252,7 @@ bool CinnamonChip::dispatchBciInstruction(SST::Cycle_t currentCycle, const std::
     // functionalUnit->addToQueue(dispatchInstruction);
     switch (op) {
     case OpCode::Bci:
-        bciQueue->addToInstructionQueue(dispatchInstruction);
+        route(bciQueue)->addToInstructionQueue(dispatchInstruction);
         break;
     }
 
@@ -733,7 +1286,7 @@ bool CinnamonChip::dispatchPl1Instruction(SST::Cycle_t currentCycle, const std::
     // functionalUnit->addToQueue(dispatchInstruction);
     switch (op) {
     case OpCode::Pl1:
-        pl1Queue->addToInstructionQueue(dispatchInstruction);
+        route(pl1Queue)->addToInstructionQueue(dispatchInstruction);
         break;
     }
 
@@ -767,7 +1320,7 @@ bool CinnamonChip::dispatchBcwInstruction(SST::Cycle_t currentCycle, const std::
     // functionalUnit->addToQueue(dispatchInstruction);
     switch (op) {
     case OpCode::BcW:
-        bcwQueue->addToInstructionQueue(dispatchInstruction);
+        route(bcwQueue)->addToInstructionQueue(dispatchInstruction);
         break;
     }
 
@@ -838,7 +1391,7 @@ bool CinnamonChip::dispatchRsvInstruction(SST::Cycle_t currentCycle, const std::
     switch (op) {
     case OpCode::Rsv:
     case OpCode::Rsi:
-        rsvQueue->addToInstructionQueue(dispatchInstruction);
+        route(rsvQueue)->addToInstructionQueue(dispatchInstruction);
         break;
     }
 
@@ -879,7 +1432,7 @@ bool CinnamonChip::dispatchModInstruction(SST::Cycle_t currentCycle, const std::
 
     switch (op) {
     case OpCode::Mod:
-        modQueue->addToInstructionQueue(dispatchInstruction);
+        route(modQueue)->addToInstructionQueue(dispatchInstruction);
         break;
     }
 
@@ -888,6 +1441,20 @@ bool CinnamonChip::dispatchModInstruction(SST::Cycle_t currentCycle, const std::
     return true;
 }
 
+uint64_t CinnamonChip::syncPayload(const CinnamonParsedInstruction &instruction, const std::shared_ptr<PhysicalRegister> &value) const {
+    if (instruction.syncBytes.has_value()) {
+        return instruction.syncBytes.value();
+    }
+    auto it = syncPayloadPerOpcode.find(instruction.opCode);
+    if (it != syncPayloadPerOpcode.end()) {
+        return it->second;
+    }
+    if (value && value->getType() == PhysicalRegister::PhysicalRegister_t::Scalar) {
+        return syncScalarPayloadBytes;
+    }
+    return syncPayloadBytes;
+}
+
 bool CinnamonChip::dispatchDisInstruction(SST::Cycle_t currentCycle, const std::shared_ptr<CinnamonParsedInstruction> &instruction) {
     using OpCode = CinnamonInstructionOpCode;
 
@@ -915,13 +1482,26 @@ bool CinnamonChip::dispatchDisInstruction(SST::Cycle_t currentCycle, const std::
         assert(srcs.size() == 1);
         srcReg = getMappedPhysicalRegister(srcs[0]);
         srcReg->incReference();
+    } else {
+        // Every participant of an exchange both sends and receives
+        assert(dests.size() == 1 && srcs.size() == 1);
+        if (canMapToPhysicalRegister(dests[0]) == false) {
+            return false;
+        }
+        srcReg = getMappedPhysicalRegister(srcs[0]);
+        srcReg->incReference();
+        destReg = mapToPhysicalRegister(dests[0]);
+        destReg->incReference();
     }
 
-    auto dispatchInstruction = std::make_shared<CinnamonDisInstruction>(op, destReg, srcReg, syncID.value(), syncSize.value());
+    auto dispatchInstruction = std::make_shared<CinnamonDisInstruction>(op, destReg, srcReg, syncID.value(), syncSize.value(), syncPayload(*instruction, srcReg ? srcReg : destReg));
 
     switch (op) {
     case OpCode::Dis:
     case OpCode::Rcv:
+    case OpCode::Agt:
+    case OpCode::Rsc:
+    case OpCode::Ata:
         disQueue->addToInstructionQueue(dispatchInstruction);
         break;
     }
@@ -963,7 +1543,7 @@ bool CinnamonChip::dispatchJoiInstruction(SST::Cycle_t currentCycle, const std::
     }
     // assert(srcs.size() == 1);
 
-    auto dispatchInstruction = std::make_shared<CinnamonDisInstruction>(op, destReg, srcReg, syncID.value(), syncSize.value(), baseIndex);
+    auto dispatchInstruction = std::make_shared<CinnamonDisInstruction>(op, destReg, srcReg, syncID.value(), syncSize.value(), syncPayload(*instruction, srcReg ? srcReg : destReg), baseIndex);
 
     switch (op) {
     case OpCode::Joi:
@@ -976,6 +1556,211 @@ bool CinnamonChip::dispatchJoiInstruction(SST::Cycle_t currentCycle, const std::
     return true;
 }
 
+bool CinnamonChip::dispatchRoiMarker(SST::Cycle_t currentCycle, const std::shared_ptr<CinnamonParsedInstruction> &instruction) {
+    using OpCode = CinnamonInstructionOpCode;
+
+    if (instruction->opCode == OpCode::RoiBegin) {
+        if (roiBegin) {
+            output->fatal(CALL_INFO, -1, "%s, Fatal: Nested or repeated roi_begin marker\n", getName().c_str());
+        }
+        outsideRoi = false;
+        roiBegin = activitySnapshot(currentCycle);
+        roiBeginInstruction = numInstructions;
+        output->verbose(CALL_INFO, 1, 0, "%s: %lu Entering region of interest after %" PRIu64 " instructions\n", getName().c_str(), currentCycle, numInstructions);
+        return true;
+    }
+
+    if (!roiBegin || roiEnd) {
+        output->fatal(CALL_INFO, -1, "%s, Fatal: roi_end marker without a matching roi_begin\n", getName().c_str());
+    }
+    // When fast-forwarding past the region, its instructions must complete before the functional mode resumes
+    if (fastForwardToRoi && (!pipelineDrained() || currentCycle < memoReplayUntil)) {
+        return false;
+    }
+    roiEnd = activitySnapshot(currentCycle);
+    roiEndInstruction = numInstructions;
+    outsideRoi = fastForwardToRoi;
+    output->verbose(CALL_INFO, 1, 0, "%s: %lu Leaving region of interest after %" PRIu64 " instructions\n", getName().c_str(), currentCycle, numInstructions);
+    return true;
+}
+
+bool CinnamonChip::dispatch(SST::Cycle_t currentCycle, const std::shared_ptr<CinnamonParsedInstruction> &instruction) {
+    using OpCode = CinnamonInstructionOpCode;
+    switch (instruction->opCode) {
+    case OpCode::LoadV:
+    case OpCode::LoadS:
+    case OpCode::Store:
+    case OpCode::Spill:
+        if (!dispatchMemoryInstruction(currentCycle, instruction)) {
+            return false;
+        }
+        freeTerm(*instruction, currentCycle);
+        return true;
+    case OpCode::Add:
+    case OpCode::Sub:
+    case OpCode::Mul:
+        return dispatchBinOpInstruction(currentCycle, instruction);
+    case OpCode::Ntt:
+        return dispatchNttInstruction(currentCycle, instruction);
+    case OpCode::Int:
+    case OpCode::Neg:
+    case OpCode::Rot:
+    case OpCode::Con:
+        return dispatchUnOpInstruction(currentCycle, instruction);
+    case OpCode::EvkGen:
+        if (config.usePRNG) {
+            return dispatchEvgInstruction(currentCycle, instruction);
+        } else {
+            // If PRNG is not to be used, turn the evkGen instruction into a load
+            instruction->opCode = OpCode::LoadV;
+            if (!dispatchMemoryInstruction(currentCycle, instruction)) {
+                return false;
+            }
+            freeTerm(*instruction, currentCycle);
+            return true;
+        }
+    case OpCode::SuD:
+        return dispatchSuDInstruction(currentCycle, instruction);
+    case OpCode::Bci:
+        return dispatchBciInstruction(currentCycle, instruction);
+    case OpCode::BcW:
+        return dispatchBcwInstruction(currentCycle, instruction);
+    case OpCode::Pl1:
+        return dispatchPl1Instruction(currentCycle, instruction);
+    case OpCode::Mov:
+        return dispatchMovInstruction(currentCycle, instruction);
+    case OpCode::Rsi:
+    case OpCode::Rsv:
+        return dispatchRsvInstruction(currentCycle, instruction);
+    case OpCode::Mod:
+        return dispatchModInstruction(currentCycle, instruction);
+    case OpCode::Rcv:
+    case OpCode::Dis:
+    case OpCode::Agt:
+    case OpCode::Rsc:
+    case OpCode::Ata:
+        return dispatchDisInstruction(currentCycle, instruction);
+    case OpCode::Joi:
+        return dispatchJoiInstruction(currentCycle, instruction);
+    case OpCode::RoiBegin:
+    case OpCode::RoiEnd:
+        return dispatchRoiMarker(currentCycle, instruction);
+    default:
+        throw std::invalid_argument("Unhandled OpCode: " + getOpCodeString(instruction->opCode));
+    }
+}
+
+CinnamonActivitySnapshot CinnamonChip::activitySnapshot(SST::Cycle_t currentCycle) const {
+    CinnamonActivitySnapshot snapshot;
+    snapshot.cycle = currentCycle;
+    for (auto &fu : functionalUnits) {
+        snapshot.fuBusyCycles.push_back(fu->busyCycles());
+        snapshot.fuIssueCycles.push_back(fu->issueCycles());
+    }
+    snapshot.memoryLoads = memoryUnit->loadsIssued();
+    snapshot.memoryStores = memoryUnit->storesIssued();
+    snapshot.memoryBusyCycles = memoryUnit->busyCycles();
+    snapshot.memoryLatency = memoryUnit->totalLatency();
+    return snapshot;
+}
+
+void CinnamonChip::replayActivity(const CinnamonActivitySnapshot &delta) {
+    for (size_t i = 0; i < functionalUnits.size(); i++) {
+        functionalUnits[i]->addReplayedCycles(delta.fuBusyCycles[i], delta.fuIssueCycles[i]);
+    }
+    memoryUnit->addReplayedActivity(delta.memoryLoads, delta.memoryStores, delta.memoryBusyCycles, delta.memoryLatency);
+}
+
+// Coarse summary of the machine state at the entry of a block. Values are bucketed by powers of two
+// so that nearby states share memoized timings
+uint64_t CinnamonChip::machineStateSummary(SST::Cycle_t currentCycle) const {
+    auto bucket = [](uint64_t val) {
+        uint64_t b = 0;
+        for (; val != 0; val >>= 1) {
+            b++;
+        }
+        return b;
+    };
+
+    size_t queued = memoryUnit->loadQueueSize() + memoryUnit->storeQueueSize();
+    for (const auto *queue : {addQueue.get(), mulQueue.get(), rotQueue.get(), evgQueue.get(), nttQueue.get(), sudQueue.get(), bciQueue.get(), bcwQueue.get(), pl1Queue.get(), rsvQueue.get(), modQueue.get(), static_cast<CinnamonInstructionQueue *>(disQueue.get())}) {
+        queued += queue->size();
+    }
+
+    // How far into the future the functional units are already reserved
+    SST::Cycle_t horizon = 0;
+    for (auto &fu : functionalUnits) {
+        if (fu->reservedUntil() > currentCycle) {
+            horizon = std::max(horizon, fu->reservedUntil() - currentCycle);
+        }
+    }
+
+    uint64_t summary = 0;
+    Utils::hashCombine(summary, bucket(queued));
+    Utils::hashCombine(summary, bucket(horizon));
+    Utils::hashCombine(summary, bucket(freeVectorRegisters.size()));
+    return summary;
+}
+
+void CinnamonChip::beginMemoBlock(SST::Cycle_t currentCycle) {
+    using OpCode = CinnamonInstructionOpCode;
+
+    auto now = activitySnapshot(currentCycle);
+    if (memoBlock) {
+        auto delta = now - memoBlock->start;
+        if (memoBlock->verify) {
+            memoizer->verify(memoBlock->key, delta);
+        } else {
+            memoizer->record(memoBlock->key, delta);
+        }
+        memoBlock.reset();
+    }
+    memoReplaying = false;
+    memoBlockRemaining = memoizer->blockSize();
+
+    // Blocks with network instructions depend on the other chips and partial blocks at the end of the trace are never memoized
+    CinnamonStructuralHasher hasher(false /* Limb indices do not affect timing */);
+    bool cacheable = true;
+    for (size_t i = 0; i < memoBlockRemaining && cacheable; i++) {
+        auto instruction = (i == 0) ? fetchedInstruction : peekInstruction(i - 1);
+        if (instruction == nullptr) {
+            cacheable = false;
+            break;
+        }
+        switch (instruction->opCode) {
+        case OpCode::Dis:
+        case OpCode::Rcv:
+        case OpCode::Joi:
+        case OpCode::Agt:
+        case OpCode::Rsc:
+        case OpCode::Ata:
+        case OpCode::RoiBegin:
+        case OpCode::RoiEnd:
+            cacheable = false;
+            break;
+        default:
+            hasher.add(*instruction);
+        }
+    }
+    if (!cacheable) {
+        memoizer->recordUncacheable();
+        return;
+    }
+
+    uint64_t key = hasher.value();
+    Utils::hashCombine(key, machineStateSummary(currentCycle));
+    auto entry = memoizer->lookup(key);
+    if (entry != nullptr && memoizer->sampleVerification() == false) {
+        memoizer->recordReplay(*entry);
+        replayActivity(entry->delta);
+        memoReplayUntil = currentCycle + entry->delta.cycle;
+        memoReplaying = true;
+        output->verbose(CALL_INFO, 3, 0, "%s: %lu Replaying memoized block. Next block at: %" PRIu64 "\n", getName().c_str(), currentCycle, memoReplayUntil);
+        return;
+    }
+    memoBlock = MemoBlock{key, entry != nullptr, now};
+}
+
 /**
  * @brief accelerator_group tick
  *
@@ -987,79 +1772,41 @@ bool CinnamonChip::tick(SST::Cycle_t currentCycle) {
     bool dispatched = false;
 
     if (fetchedInstruction == nullptr) {
-        fetchedInstruction = reader->readNextInstruction(0);
+        fetchedInstruction = fetchInstruction();
         numInstructions++;
     }
 
     while (fetchedInstruction) {
-        using OpCode = CinnamonInstructionOpCode;
-        switch (fetchedInstruction->opCode) {
-        case OpCode::LoadV:
-        case OpCode::LoadS:
-        case OpCode::Store:
-        case OpCode::Spill:
-            dispatched = dispatchMemoryInstruction(currentCycle, fetchedInstruction);
-            break;
-        case OpCode::Add:
-        case OpCode::Sub:
-        case OpCode::Mul:
-            dispatched = dispatchBinOpInstruction(currentCycle, fetchedInstruction);
-            break;
-        case OpCode::Ntt:
-            dispatched = dispatchNttInstruction(currentCycle, fetchedInstruction);
-            break;
-        case OpCode::Int:
-        case OpCode::Neg:
-        case OpCode::Rot:
-        case OpCode::Con:
-            dispatched = dispatchUnOpInstruction(currentCycle, fetchedInstruction);
-            break;
-        case OpCode::EvkGen:
-            if (config.usePRNG) {
-                dispatched = dispatchEvgInstruction(currentCycle, fetchedInstruction);
-            } else {
-                // If PRNG is not to be used, turn the evkGen instruction into a load
-                fetchedInstruction->opCode = OpCode::LoadV;
-                dispatched = dispatchMemoryInstruction(currentCycle, fetchedInstruction);
+        if (memoizer && !outsideRoi && memoBlockRemaining == 0) {
+            if (currentCycle < memoReplayUntil) {
+                break; // The time of the replayed block has not elapsed yet
             }
-            break;
-        case OpCode::SuD:
-            dispatched = dispatchSuDInstruction(currentCycle, fetchedInstruction);
-            break;
-        case OpCode::Bci:
-            dispatched = dispatchBciInstruction(currentCycle, fetchedInstruction);
-            break;
-        case OpCode::BcW:
-            dispatched = dispatchBcwInstruction(currentCycle, fetchedInstruction);
-            break;
-        case OpCode::Pl1:
-            dispatched = dispatchPl1Instruction(currentCycle, fetchedInstruction);
-            break;
-        case OpCode::Mov:
-            dispatched = dispatchMovInstruction(currentCycle, fetchedInstruction);
-            break;
-        case OpCode::Rsi:
-        case OpCode::Rsv:
-            dispatched = dispatchRsvInstruction(currentCycle, fetchedInstruction);
-            break;
-        case OpCode::Mod:
-            dispatched = dispatchModInstruction(currentCycle, fetchedInstruction);
-            break;
-        case OpCode::Rcv:
-        case OpCode::Dis:
-            dispatched = dispatchDisInstruction(currentCycle, fetchedInstruction);
-            break;
-        case OpCode::Joi:
-            dispatched = dispatchJoiInstruction(currentCycle, fetchedInstruction);
-            break;
-        default:
-            throw std::invalid_argument("Unhandled OpCode: " + getOpCodeString(fetchedInstruction->opCode));
+            beginMemoBlock(currentCycle);
         }
+        if (limbGroupLimit > 1 && limbGroupRemaining == 0 && !fastForwarding()) {
+            limbGroupRemaining = formLimbGroup();
+            limbGroupOpen = limbGroupRemaining > 1;
+        }
+
+        dispatched = dispatch(currentCycle, fetchedInstruction);
 
         if (!dispatched) {
             break;
         } else {
-            fetchedInstruction = reader->readNextInstruction(0);
+            if (memoizer && memoBlockRemaining > 0) {
+                memoBlockRemaining--;
+            }
+            if (limbGroupRemaining > 0) {
+                limbGroupRemaining--;
+                if (limbGroupRemaining == 0 && limbGroupOpen) {
+                    closeLimbGroup();
+                }
+            }
+            if (sampler && !outsideRoi && sampler->dispatched()) {
+                sampler->advance(activitySnapshot(currentCycle));
+            }
+            leavePrefetchWindow(*fetchedInstruction);
+            fetchedInstruction = fetchInstruction();
             numInstructions++;
             if (numInstructions % 100000 == 0) {
                 uint64_t mils = numInstructions / 1000000;
@@ -1085,6 +1832,7 @@ bool CinnamonChip::tick(SST::Cycle_t currentCycle) {
 
     if (!fetchedInstruction) {
         traceCompleted = true;
+        memoryUnit->drain();
     }
 
     addQueue->tick(currentCycle);
@@ -1099,7 +1847,11 @@ bool CinnamonChip::tick(SST::Cycle_t currentCycle) {
     rsvQueue->tick(currentCycle);
     modQueue->tick(currentCycle);
     disQueue->tick(currentCycle);
+    fastForwardQueue->tick(currentCycle);
 
+    if (prefetchWindow > 0 && !fastForwarding()) {
+        prefetchLookahead();
+    }
     memoryUnit->executeCycleBegin(currentCycle);
     for (int i = 0; i < functionalUnits.size(); i++) {
         functionalUnits.at(i)->executeCycleBegin(currentCycle);
@@ -1117,23 +1869,11 @@ bool CinnamonChip::tick(SST::Cycle_t currentCycle) {
 
     if (traceCompleted) {
 
-        bool okayToFinish = memoryUnit->okayToFinish();
-        for (int i = 0; i < functionalUnits.size(); i++) {
-            okayToFinish = okayToFinish && functionalUnits[i]->okayToFinish();
-        }
-        okayToFinish = okayToFinish && addQueue->okayToFinish();
-        okayToFinish = okayToFinish && mulQueue->okayToFinish();
-        okayToFinish = okayToFinish && rotQueue->okayToFinish();
-        okayToFinish = okayToFinish && evgQueue->okayToFinish();
-        okayToFinish = okayToFinish && nttQueue->okayToFinish();
-        okayToFinish = okayToFinish && sudQueue->okayToFinish();
-        okayToFinish = okayToFinish && bciQueue->okayToFinish();
-        okayToFinish = okayToFinish && bcwQueue->okayToFinish();
-        okayToFinish = okayToFinish && pl1Queue->okayToFinish();
-        okayToFinish = okayToFinish && rsvQueue->okayToFinish();
-        okayToFinish = okayToFinish && modQueue->okayToFinish();
-        okayToFinish = okayToFinish && disQueue->okayToFinish();
+        bool okayToFinish = pipelineDrained() && currentCycle >= memoReplayUntil;
         if (okayToFinish) {
+            if (completionCycle_ == 0) {
+                completionCycle_ = currentCycle;
+            }
             output->verbose(CALL_INFO, 1, 0, "CinnamonChip: Test Completed Successfuly\n");
             return true; // Turn our clock off while we wait for any other accelerator_groups to end
         }
@@ -1142,5 +1882,26 @@ bool CinnamonChip::tick(SST::Cycle_t currentCycle) {
     return false;
 }
 
+bool CinnamonChip::pipelineDrained() {
+    bool okayToFinish = memoryUnit->okayToFinish();
+    for (int i = 0; i < functionalUnits.size(); i++) {
+        okayToFinish = okayToFinish && functionalUnits[i]->okayToFinish();
+    }
+    okayToFinish = okayToFinish && addQueue->okayToFinish();
+    okayToFinish = okayToFinish && mulQueue->okayToFinish();
+    okayToFinish = okayToFinish && rotQueue->okayToFinish();
+    okayToFinish = okayToFinish && evgQueue->okayToFinish();
+    okayToFinish = okayToFinish && nttQueue->okayToFinish();
+    okayToFinish = okayToFinish && sudQueue->okayToFinish();
+    okayToFinish = okayToFinish && bciQueue->okayToFinish();
+    okayToFinish = okayToFinish && bcwQueue->okayToFinish();
+    okayToFinish = okayToFinish && pl1Queue->okayToFinish();
+    okayToFinish = okayToFinish && rsvQueue->okayToFinish();
+    okayToFinish = okayToFinish && modQueue->okayToFinish();
+    okayToFinish = okayToFinish && disQueue->okayToFinish();
+    okayToFinish = okayToFinish && fastForwardQueue->okayToFinish();
+    return okayToFinish;
+}
+
 } // Namespace Cinnamon
 } // Namespace SST
@@ -2,7 +2,11 @@
 #ifndef CINNAMON_CHIPLET_H
 #define CINNAMON_CHIPLET_H
 
+#include <deque>
+#include <map>
+#include <optional>
 #include <queue>
+#include <unordered_map>
 
 #include "sst/core/component.h"
 #include "sst/core/event.h"
@@ -18,6 +22,10 @@
 #include "utils/utils.h"
 
 #include "baseConversionRegister.h"
+#include "memoizer.h"
+#include "sampling.h"
+#include "scratchpad.h"
+#include "termAllocator.h"
 #include "physicalRegister.h"
 // #include "instruction.h"
 // #include "functionalUnit.h"
@@ -58,8 +66,10 @@ class CinnamonFunctionalUnit;
 class CinnamonBaseConversionUnit;
 
 class CinnamonInstructionQueue;
+class CinnamonLimbGroupQueue;
 class CinnamonAddQueue;
 class CinnamonMulQueue;
+class CinnamonDisQueue;
 class CinnamonRotQueue;
 class CinnamonEvgQueue;
 class CinnamonNttQueue;
@@ -88,6 +98,30 @@ public:
         stats_.busyCyclesWindow += val;
     }
 
+    // An element-wise instruction started savedCycles before the streamed operand it reads was complete
+    void recordStreamedStart(SST::Cycle_t savedCycles);
+
+    // A memory instruction completed by the fast-forward queue no longer keeps its limbs busy
+    void releaseMemoryInstruction(const CinnamonMemoryInstruction &instruction);
+
+    size_t freeVectorRegisterCount() const {
+        return freeVectorRegisters.size();
+    }
+
+    std::uint64_t traceFingerprint() {
+        return reader->traceFingerprint();
+    }
+
+    // Cycle at which the chip drained its trace. Zero while still running
+    SST::Cycle_t completionCycle() const {
+        return completionCycle_;
+    }
+
+    // The chip is not simulated. Its timing and statistics are those of representative
+    void setReplayedFrom(const CinnamonChip *representative) {
+        replayedFrom = representative;
+    }
+
     SST_ELI_REGISTER_SUBCOMPONENT_API(SST::Cinnamon::CinnamonChip, CinnamonAccelerator *, CinnamonNetwork *, uint32_t)
 
     SST_ELI_REGISTER_SUBCOMPONENT(
@@ -98,6 +132,80 @@ public:
         "Cinnamon Chip",
         SST::Cinnamon::CinnamonChip);
 
+    SST_ELI_DOCUMENT_PARAMS(
+        {"verbose", "Verbosity for debugging. Increased numbers for increased verbosity.", "0"},
+        {"numVectorRegs", "Number of physical vector registers", "1024"},
+        {"usePRNG", "Generate evaluation keys on chip. Otherwise they are loaded from memory", "true"},
+        {"memoryRequestWidth", "Size in bytes of each request sent to memory", "1024"},
+        {"numMSHRs", "Number of limb transfers the memory unit can have in flight", "2"},
+        {"maxOutstandingLoads", "Maximum number of loads in flight. Defaults to numMSHRs", ""},
+        {"maxOutstandingStores", "Maximum number of stores and spills in flight. Defaults to numMSHRs", ""},
+        {"memoryTransferMode", "request: split each transfer into memoryRequestWidth byte requests. bulk: send each transfer as bulkTransferSize byte requests to a backend that streams them", "request"},
+        {"bulkTransferSize", "Size in bytes of bulk requests. 0 sends every transfer as a single request", "0"},
+        {"inOrderMemoryCompletion", "Complete memory transfers in issue order instead of as soon as their last response arrives", "false"},
+        {"loadQueueCapacity", "Entries in the memory unit load queue. Dispatch stalls when it is full. 0 leaves it unbounded", "0"},
+        {"storeQueueCapacity", "Entries in the memory unit store queue, shared by stores and spills. Dispatch stalls when it is full. 0 leaves it unbounded", "0"},
+        {"scalarQueueCapacity", "Entries in the memory unit scalar load queue. Dispatch stalls when it is full. 0 leaves it unbounded", "0"},
+        {"memoryArbitration", "Order in which ready loads, stores and spills are issued: loadsFirst, age, deadline (loads with waiting consumers first, stores first under register pressure) or deferSpills", "loadsFirst"},
+        {"storeQueueWatermark", "deferSpills: spills are held back until this many stores and spills are queued", "8"},
+        {"freeRegisterWatermark", "deadline and deferSpills: stores and spills become urgent when fewer vector registers are free", "16"},
+        {"spillDeferLimit", "deferSpills: cycles after which a held back spill is issued regardless of the watermarks", "10000"},
+        {"prefetchWindow", "Number of upcoming trace instructions scanned for loads to prefetch. 0 disables prefetching", "0"},
+        {"prefetchBufferSize", "Number of limbs held by the prefetch buffer", "16"},
+        {"modelScalarLoads", "Transfer scalar loads from memory. When false scalar loads complete as soon as they are dispatched", "true"},
+        {"scalarBurstSize", "Adjacent queued scalar loads are issued as one transfer of up to this many bytes. 0 disables coalescing", "28672"},
+        {"scalarCacheCapacity", "Number of scalars held by the on-chip scalar cache. 0 disables the cache", "0"},
+        {"scalarCacheBankWidth", "Bytes the scalar cache reads per cycle", "1024"},
+        {"scalarCachePolicy", "Replacement policy of the scalar cache: lru, lfu or belady", "lru"},
+
+        // Network
+        {"maxOutstandingSyncs", "Number of network instructions a chip can have in flight at once", "1"},
+        {"networkInjectionWidth", "Bytes per cycle the chip sends into the network. 0 sends values instantly", "0"},
+        {"networkEjectionWidth", "Bytes per cycle the chip receives from the network. 0 receives results instantly", "0"},
+        {"streamingReceive", "Write received results into their register chunk by chunk as they are ejected, so element-wise add, sub, neg and mul can start before the last byte arrives. Needs networkEjectionWidth", "false"},
+        {"streamChunkBytes", "streamingReceive: bytes written into the register at a time", "1024"},
+
+        {"syncPayloadBytes", "Bytes a network instruction on a vector register sends or receives when the trace does not give its size", "229376"},
+        {"syncScalarPayloadBytes", "Bytes a network instruction on a scalar register sends or receives when the trace does not give its size", "7168"},
+        {"syncPayloadBytesPerOpcode", "Array of opcode:bytes entries (dis, rcv, joi, agt, rsc or ata) that override the payload of an opcode when the trace does not give its size", "[]"},
+
+        // Term placement
+        {"termPlacement", "Placement of term limbs in memory: sequential, channelInterleaved or bankStriped", "sequential"},
+        {"reclaimFreedTerms", "Reuse the memory of terms loaded with the {F} flag once no transfer to it is in flight", "true"},
+        {"placementChannels", "Number of memory channels assumed by the placement", "8"},
+        {"placementBanks", "Number of banks per channel assumed by the placement", "16"},
+        {"placementInterleaveSize", "Size in bytes of the chunks the memory stripes across channels, assumed by the placement", "256"},
+
+        // Scratchpad
+        {"scratchpadCapacity", "Number of limbs held by the on-chip scratchpad that loads are served from. 0 disables the scratchpad", "0"},
+        {"scratchpadBanks", "Number of scratchpad banks. Limbs are assigned to banks by address", "8"},
+        {"scratchpadBankWidth", "Bytes a scratchpad bank reads per cycle", "1024"},
+        {"scratchpadPolicy", "Replacement policy of the scratchpad: lru, lfu or belady", "lru"},
+        {"scratchpadLookahead", "Number of upcoming trace instructions the belady policy searches for the next load of a limb", "10000"},
+
+        // Timing memoization
+        {"memoize", "Reuse the recorded timing of instruction blocks that repeat with the same machine state", "false"},
+        {"memoBlockSize", "Number of instructions in a memoized block", "256"},
+        {"memoStrict", "Simulate a sample of memoization hits in detail and report the error of the recorded timing", "false"},
+        {"memoVerifyRate", "Fraction of hits that are verified in strict mode", "0.05"},
+        {"memoSeed", "Seed used to sample the verified hits", "1"},
+
+        // Limb group coarsening
+        {"limbGroupSize", "Merge up to this many consecutive independent instructions with the same opcode on different limbs into one macro-instruction. 1 disables coarsening", "1"},
+        {"referenceCycles", "Cycles taken by a full detail run of the same trace. Used to report the error of coarsening", "0"},
+
+        // Region of interest
+        {"fastForwardToRoi", "Only dispatch and rename instructions outside the region delimited by roi_begin and roi_end. The region is simulated in full detail", "false"},
+
+        // Sampled simulation
+        {"sampling", "Alternate between detailed and functionally fast-forwarded intervals and extrapolate cycles and utilisation", "false"},
+        {"samplingDetailedLength", "Instructions in each measured detailed interval", "1000"},
+        {"samplingWarmupLength", "Instructions simulated in detail before each measured interval to warm up queues and functional units", "2000"},
+        {"samplingFastForwardLength", "Instructions fast-forwarded between detailed intervals", "97000"},
+        {"samplingTargetError", "Target relative half-width of the confidence interval of the total cycles", "0.02"},
+        {"samplingConfidenceZ", "Standard normal quantile of the confidence level of the intervals", "1.96"},
+    )
+
     SST_ELI_DOCUMENT_PORTS(
         {"memory_link", "Link to the memory hierarchy (e.g., HBM)", {"memHierarchy.memEvent", ""}},
         {"cinnamon_network_port", "Link to the memory hierarchy (e.g., HBM)", {"memHierarchy.memEvent", ""}})
@@ -136,13 +244,22 @@ private:
     std::map<std::uint16_t, PhysicalRegisterID_t> scalarRegisterRenameMap;
     std::map<std::uint16_t, BaseConversionRegister::VirtualID_t> baseConversionVirtualRegisterRenameMap;
     std::map<std::string, SST::Interfaces::StandardMem::Addr> termToAddressMap;
-    uint64_t numTerms = 0;
+    std::unique_ptr<CinnamonTermAllocator> termAllocator;
+    // Scalars are kept in their own region so that consecutive scalar terms are adjacent and coalesce
+    std::unique_ptr<CinnamonTermAllocator> scalarAllocator;
+    bool reclaimFreedTerms = true;
 
     std::queue<PhysicalRegisterID_t> freeVectorRegisters;
     std::queue<PhysicalRegisterID_t> freeScalarRegisters;
     std::queue<BaseConversionRegister::VirtualID_t> freeBaseConversionVirtualRegisters;
 
     std::shared_ptr<CinnamonParsedInstruction> fetchedInstruction;
+    std::deque<std::shared_ptr<CinnamonParsedInstruction>> lookahead;
+
+    std::shared_ptr<CinnamonParsedInstruction> fetchInstruction();
+    // Returns the instruction n positions after the fetched instruction without consuming it.
+    // Returns nullptr past the end of the trace
+    std::shared_ptr<CinnamonParsedInstruction> peekInstruction(size_t n);
 
     bool canMapToPhysicalRegister(const CinnamonParsedValueType &val);
     std::shared_ptr<PhysicalRegister> mapToPhysicalRegister(const CinnamonParsedValueType &val);
@@ -167,6 +284,88 @@ private:
     bool dispatchModInstruction(SST::Cycle_t currentCycle, const std::shared_ptr<CinnamonParsedInstruction> &instruction);
     bool dispatchDisInstruction(SST::Cycle_t currentCycle, const std::shared_ptr<CinnamonParsedInstruction> &instruction);
     bool dispatchJoiInstruction(SST::Cycle_t currentCycle, const std::shared_ptr<CinnamonParsedInstruction> &instruction);
+    bool dispatchRoiMarker(SST::Cycle_t currentCycle, const std::shared_ptr<CinnamonParsedInstruction> &instruction);
+    bool dispatch(SST::Cycle_t currentCycle, const std::shared_ptr<CinnamonParsedInstruction> &instruction);
+
+    void enqueueMemoryInstruction(const std::shared_ptr<CinnamonMemoryInstruction> &instruction);
+    SST::Interfaces::StandardMem::Addr termAddress(const std::string &term, uint16_t limbIndex, SST::Cycle_t currentCycle, bool scalar = false);
+    // Releases the memory of a term whose last load has been dispatched
+    void freeTerm(const CinnamonParsedInstruction &instruction, SST::Cycle_t currentCycle);
+
+    // True for instructions that read a limb from memory
+    bool loadsFromMemory(const CinnamonParsedInstruction &instruction) const;
+
+    // Lookahead prefetching
+    size_t prefetchWindow = 0;
+    // Instructions at the front of the window that have been scanned, and the terms the scanned stores and spills write
+    size_t prefetchScanned = 0;
+    std::unordered_map<std::string, size_t> prefetchWindowStores;
+    void prefetchLookahead();
+    // Removes the fetched instruction from the window when it is dispatched
+    void leavePrefetchWindow(const CinnamonParsedInstruction &instruction);
+
+    std::unique_ptr<CinnamonScratchpad> scratchpad;
+    std::unique_ptr<CinnamonScratchpad> scalarCache;
+    size_t scratchpadLookahead = 10000;
+    bool modelScalarLoads = true;
+    // Distance in instructions from the fetched instruction to the next load of each limb within the lookahead
+    std::unordered_map<SST::Interfaces::StandardMem::Addr, size_t> upcomingLoads();
+    // Serves a load from an on-chip cache. On a miss the limb is allocated and false is returned
+    bool readCached(CinnamonScratchpad &cache, const std::shared_ptr<CinnamonMemoryInstruction> &instruction, SST::Cycle_t currentCycle);
+
+    // A limb holds 64K and a scalar 2048 coefficients of 28 bits
+    static constexpr size_t limbBytes = (64 * 1024 * 28) / 8; // 224 KB
+    static constexpr size_t scalarBytes = (2048 * 28) / 8;    // 7 KB
+
+    // Payload of network instructions that do not give it in the trace
+    uint64_t syncPayloadBytes = limbBytes;
+    uint64_t syncScalarPayloadBytes = scalarBytes;
+    std::map<CinnamonInstructionOpCode, uint64_t> syncPayloadPerOpcode;
+    uint64_t syncPayload(const CinnamonParsedInstruction &instruction, const std::shared_ptr<PhysicalRegister> &value) const;
+
+    // While fast-forwarding, dispatched instructions are completed functionally instead of being simulated
+    bool memoReplaying = false;
+    bool outsideRoi = false;
+    bool fastForwarding() const {
+        return memoReplaying || outsideRoi || (sampler && sampler->fastForwarding());
+    }
+    CinnamonInstructionQueue *route(const std::unique_ptr<CinnamonInstructionQueue> &queue);
+
+    // Limb group coarsening
+    std::uint16_t limbGroupLimit = 1;
+    std::unique_ptr<CinnamonLimbGroupQueue> limbGroup;
+    size_t limbGroupRemaining = 0;
+    bool limbGroupOpen = false;
+    SST::Cycle_t referenceCycles = 0;
+
+    size_t formLimbGroup();
+    void closeLimbGroup();
+
+    // Timing memoization
+    struct MemoBlock {
+        uint64_t key;
+        bool verify;
+        CinnamonActivitySnapshot start;
+    };
+    std::unique_ptr<CinnamonTimingMemoizer> memoizer;
+    std::optional<MemoBlock> memoBlock; // Block being simulated in detail
+    size_t memoBlockRemaining = 0;
+    SST::Cycle_t memoReplayUntil = 0;
+
+    void beginMemoBlock(SST::Cycle_t currentCycle);
+    bool pipelineDrained();
+
+    std::unique_ptr<CinnamonSamplingController> sampler;
+
+    // Region of interest
+    bool fastForwardToRoi = false;
+    std::optional<CinnamonActivitySnapshot> roiBegin;
+    std::optional<CinnamonActivitySnapshot> roiEnd;
+    uint64_t roiBeginInstruction = 0;
+    uint64_t roiEndInstruction = 0;
+    uint64_t machineStateSummary(SST::Cycle_t currentCycle) const;
+    CinnamonActivitySnapshot activitySnapshot(SST::Cycle_t currentCycle) const;
+    void replayActivity(const CinnamonActivitySnapshot &delta);
 
     std::unique_ptr<CinnamonMemoryUnit> memoryUnit;
     std::vector<std::shared_ptr<CinnamonFunctionalUnit>> functionalUnits;
@@ -186,7 +385,8 @@ private:
     std::unique_ptr<CinnamonInstructionQueue> pl4Queue;
     std::unique_ptr<CinnamonInstructionQueue> rsvQueue;
     std::unique_ptr<CinnamonInstructionQueue> modQueue;
-    std::unique_ptr<CinnamonInstructionQueue> disQueue;
+    std::unique_ptr<CinnamonDisQueue> disQueue;
+    std::unique_ptr<CinnamonInstructionQueue> fastForwardQueue;
     // std::unique_ptr<CinnamonInstructionQueue> joiQueue;
 
     void dummyHandler(SST::Event *ev){};
@@ -195,6 +395,8 @@ private:
     std::unique_ptr<SST::Cinnamon::CinnamonTraceReader> reader;
 
     uint64_t numInstructions;
+    SST::Cycle_t completionCycle_ = 0;
+    const CinnamonChip *replayedFrom = nullptr;
 
     CinnamonAccelerator *accelerator;
     uint32_t chipID_;
@@ -208,6 +410,8 @@ private:
         SST::Cycle_t busyCyclesWindow = 0;
         uint64_t vectorRegisterReads = 0;
         uint64_t vectorRegisterWrites = 0;
+        uint64_t macroInstructions = 0;
+        uint64_t coarsenedInstructions = 0;
     } stats_;
 
     struct Config {
@@ -0,0 +1,236 @@
+// Copyright (c) Siddharth Jayashankar. All rights reserved.
+#include "collective.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace SST {
+namespace Cinnamon {
+
+CinnamonCollective::Algorithm CinnamonCollective::parseAlgorithm(const std::string &algorithm) {
+    if (algorithm == "direct") {
+        return Algorithm::Direct;
+    }
+    if (algorithm == "chain") {
+        return Algorithm::Chain;
+    }
+    if (algorithm == "ring") {
+        return Algorithm::Ring;
+    }
+    if (algorithm == "tree") {
+        return Algorithm::Tree;
+    }
+    throw std::invalid_argument("Unknown collective algorithm " + algorithm + ". Expected direct, chain, ring or tree");
+}
+
+CinnamonCollective::CinnamonCollective(size_t numChips, Algorithm algorithm, const std::map<size_t, Algorithm> &thresholds, uint64_t chunkSize, size_t chipsPerBoard) : numChips(numChips), algorithm(algorithm), thresholds(thresholds), chunkSize(chunkSize), chipsPerBoard(chipsPerBoard ? chipsPerBoard : numChips) {
+    if (numChips % this->chipsPerBoard != 0) {
+        throw std::invalid_argument("Chips per board " + std::to_string(chipsPerBoard) + " does not divide the number of chips " + std::to_string(numChips));
+    }
+}
+
+CinnamonCollective::Algorithm CinnamonCollective::select(size_t syncSize) const {
+    auto it = thresholds.lower_bound(syncSize);
+    return it == thresholds.end() ? algorithm : it->second;
+}
+
+std::vector<uint64_t> CinnamonCollective::chunks(uint64_t bytes) const {
+    if (chunkSize == 0 || chunkSize >= bytes) {
+        return {bytes};
+    }
+    std::vector<uint64_t> sizes(bytes / chunkSize, chunkSize);
+    if (bytes % chunkSize) {
+        sizes.push_back(bytes % chunkSize);
+    }
+    return sizes;
+}
+
+std::vector<std::pair<size_t, size_t>> CinnamonCollective::tree(Algorithm algorithm, size_t root, const std::vector<size_t> &participants) const {
+    if (chipsPerBoard == numChips) {
+        return levelTree(algorithm, root, participants, [&](size_t p) { return (p + numChips - root) % numChips; });
+    }
+    // Participants of each board, and the representative that receives from or sends to the other boards
+    const size_t numBoards = numChips / chipsPerBoard;
+    const size_t rootBoard = root / chipsPerBoard;
+    std::map<size_t, std::vector<size_t>> boards;
+    std::map<size_t, size_t> representatives{{rootBoard, root}};
+    for (auto p : participants) {
+        size_t b = p / chipsPerBoard;
+        boards[b].push_back(p);
+        auto it = representatives.find(b);
+        if (it == representatives.end() || (b != rootBoard && p % chipsPerBoard < it->second % chipsPerBoard)) {
+            representatives[b] = p;
+        }
+    }
+    std::vector<size_t> remoteRepresentatives;
+    for (auto &[b, representative] : representatives) {
+        if (b != rootBoard) {
+            remoteRepresentatives.push_back(representative);
+        }
+    }
+    auto edges = levelTree(algorithm, root, remoteRepresentatives, [&](size_t p) {
+        return (p / chipsPerBoard + numBoards - rootBoard) % numBoards;
+    });
+    for (auto &[b, members] : boards) {
+        size_t representative = representatives.at(b);
+        std::vector<size_t> others;
+        for (auto p : members) {
+            if (p != representative) {
+                others.push_back(p);
+            }
+        }
+        auto boardEdges = levelTree(algorithm, representative, others, [&](size_t p) {
+            return (p + chipsPerBoard - representative % chipsPerBoard) % chipsPerBoard;
+        });
+        edges.insert(edges.end(), boardEdges.begin(), boardEdges.end());
+    }
+    return edges;
+}
+
+template <typename Distance>
+std::vector<std::pair<size_t, size_t>> CinnamonCollective::levelTree(Algorithm algorithm, size_t root, std::vector<size_t> participants, Distance distance) const {
+    std::sort(participants.begin(), participants.end(), [&](size_t a, size_t b) {
+        return distance(a) < distance(b);
+    });
+    std::vector<std::pair<size_t, size_t>> edges;
+    switch (algorithm) {
+    case Algorithm::Direct:
+        for (auto p : participants) {
+            edges.emplace_back(root, p);
+        }
+        break;
+    case Algorithm::Chain: {
+        size_t previous = root;
+        for (auto p : participants) {
+            edges.emplace_back(previous, p);
+            previous = p;
+        }
+        break;
+    }
+    case Algorithm::Ring: {
+        // The first half is closer going forwards around the ring, the second half going backwards
+        size_t half = (participants.size() + 1) / 2;
+        size_t previous = root;
+        for (size_t i = 0; i < half; i++) {
+            edges.emplace_back(previous, participants[i]);
+            previous = participants[i];
+        }
+        previous = root;
+        for (size_t i = participants.size(); i > half; i--) {
+            edges.emplace_back(previous, participants[i - 1]);
+            previous = participants[i - 1];
+        }
+        break;
+    }
+    case Algorithm::Tree: {
+        participants.insert(participants.begin(), root);
+        for (size_t step = 1; step < participants.size(); step *= 2) {
+            for (size_t i = 0; i < step && i + step < participants.size(); i++) {
+                edges.emplace_back(participants[i], participants[i + step]);
+            }
+        }
+        break;
+    }
+    }
+    return edges;
+}
+
+std::vector<std::pair<size_t, SimTime_t>> CinnamonCollective::broadcast(CinnamonTopology &topology, Algorithm algorithm, size_t root, const std::vector<size_t> &destinations, uint64_t bytes, SimTime_t start) {
+    stats_.broadcasts[static_cast<int>(algorithm)]++;
+    return scheduleBroadcast(topology, algorithm, root, destinations, bytes, start);
+}
+
+SimTime_t CinnamonCollective::reduce(CinnamonTopology &topology, Algorithm algorithm, size_t root, const std::vector<std::pair<size_t, SimTime_t>> &inputs, uint64_t bytes) {
+    stats_.reductions[static_cast<int>(algorithm)]++;
+    return scheduleReduce(topology, algorithm, root, inputs, bytes);
+}
+
+std::vector<std::pair<size_t, SimTime_t>> CinnamonCollective::allGather(CinnamonTopology &topology, Algorithm algorithm, size_t source, const std::vector<size_t> &destinations, uint64_t bytes, SimTime_t start) {
+    stats_.allGathers[static_cast<int>(algorithm)]++;
+    return scheduleBroadcast(topology, algorithm, source, destinations, bytes, start);
+}
+
+std::vector<std::pair<size_t, SimTime_t>> CinnamonCollective::allToAll(CinnamonTopology &topology, size_t source, const std::vector<size_t> &destinations, uint64_t bytes, SimTime_t start) {
+    stats_.allToAlls++;
+    // Every destination gets a different share, so nothing can be forwarded on its behalf
+    return scheduleBroadcast(topology, Algorithm::Direct, source, destinations, bytes, start);
+}
+
+std::vector<std::pair<size_t, SimTime_t>> CinnamonCollective::reduceScatter(CinnamonTopology &topology, Algorithm algorithm, const std::vector<std::pair<size_t, SimTime_t>> &inputs, uint64_t bytes) {
+    stats_.reduceScatters[static_cast<int>(algorithm)]++;
+    std::vector<std::pair<size_t, SimTime_t>> complete;
+    for (auto &[root, time] : inputs) {
+        complete.emplace_back(root, scheduleReduce(topology, algorithm, root, inputs, bytes));
+    }
+    return complete;
+}
+
+std::vector<std::pair<size_t, SimTime_t>> CinnamonCollective::scheduleBroadcast(CinnamonTopology &topology, Algorithm algorithm, size_t root, const std::vector<size_t> &destinations, uint64_t bytes, SimTime_t start) {
+    auto edges = tree(algorithm, root, destinations);
+    std::vector<SimTime_t> ready(numChips, start);
+    std::vector<SimTime_t> done(numChips, start);
+    for (auto size : chunks(bytes)) {
+        ready[root] = start;
+        for (auto &[parent, child] : edges) {
+            ready[child] = topology.transfer(parent, child, size, ready[parent]);
+            done[child] = std::max(done[child], ready[child]);
+            stats_.chunkTransfers++;
+        }
+    }
+    std::vector<std::pair<size_t, SimTime_t>> arrivals;
+    for (auto destination : destinations) {
+        arrivals.emplace_back(destination, done[destination]);
+    }
+    return arrivals;
+}
+
+SimTime_t CinnamonCollective::scheduleReduce(CinnamonTopology &topology, Algorithm algorithm, size_t root, const std::vector<std::pair<size_t, SimTime_t>> &inputs, uint64_t bytes) {
+    std::vector<SimTime_t> inputTime(numChips, 0);
+    std::vector<size_t> participants;
+    for (auto &[chip, time] : inputs) {
+        inputTime[chip] = time;
+        if (chip != root) {
+            participants.push_back(chip);
+        }
+    }
+    auto edges = tree(algorithm, root, participants);
+    SimTime_t complete = inputTime[root];
+    for (auto size : chunks(bytes)) {
+        // Children are reduced into their parent before the parent forwards the chunk
+        auto available = inputTime;
+        for (auto edge = edges.rbegin(); edge != edges.rend(); edge++) {
+            auto [parent, child] = *edge;
+            available[parent] = std::max(available[parent], topology.transfer(child, parent, size, available[child]));
+            stats_.chunkTransfers++;
+        }
+        complete = std::max(complete, available[root]);
+    }
+    return complete;
+}
+
+std::string CinnamonCollective::printStats() const {
+    static const char *algorithmNames[] = {"Direct", "Chain", "Ring", "Tree"};
+    std::stringstream s;
+    s << "Collectives\n";
+    s << "\tChunk Size: " << (chunkSize ? std::to_string(chunkSize) : std::string("whole value")) << "\n";
+    if (chipsPerBoard != numChips) {
+        s << "\tHierarchical Over Boards Of: " << chipsPerBoard << " chips\n";
+    }
+    for (int i = 0; i < 4; i++) {
+        if (stats_.broadcasts[i] || stats_.reductions[i]) {
+            s << "\t" << algorithmNames[i] << " Broadcasts: " << stats_.broadcasts[i] << "\n";
+            s << "\t" << algorithmNames[i] << " Reductions: " << stats_.reductions[i] << "\n";
+        }
+        if (stats_.allGathers[i] || stats_.reduceScatters[i]) {
+            s << "\t" << algorithmNames[i] << " All-Gather Sources: " << stats_.allGathers[i] << "\n";
+            s << "\t" << algorithmNames[i] << " Reduce-Scatters: " << stats_.reduceScatters[i] << "\n";
+        }
+    }
+    s << "\tAll-To-All Sources: " << stats_.allToAlls << "\n";
+    s << "\tChunk Transfers: " << stats_.chunkTransfers << "\n";
+    return s.str();
+}
+
+} // namespace Cinnamon
+} // namespace SST
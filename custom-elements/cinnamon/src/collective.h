@@ -0,0 +1,90 @@
+// Copyright (c) Siddharth Jayashankar. All rights reserved.
+#ifndef _H_SST_CINNAMON_COLLECTIVE
+#define _H_SST_CINNAMON_COLLECTIVE
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sst/core/sst_types.h"
+#include "topology.h"
+
+namespace SST {
+namespace Cinnamon {
+
+// Schedules broadcasts, reductions and the exchanges built from them as a sequence of chunk transfers over a topology.
+// Participants other than the root are ordered by their distance from the root along the chip ring.
+// A chip forwards a chunk as soon as it has received it (and, when reducing, has its own input and the
+// chunk from each of its children), so with a chunk size below the payload size transfers pipeline.
+//  direct: the root exchanges the whole value with every participant
+//  chain:  the value travels along all participants in order
+//  ring:   two chains, one in each direction around the ring, each covering half of the participants
+//  tree:   binomial tree rooted at the root
+// An all-gather broadcasts the value of every participant, a reduce-scatter reduces a 1/n share into each participant
+// and an all-to-all sends a distinct 1/n share straight to each participant, so it always behaves like direct.
+// With boards of chipsPerBoard chips the collective is hierarchical: every board has one representative (the root
+// on its own board, the participant closest to the gateway elsewhere), the algorithm runs once between the
+// representatives over the fabric and once within each board, so every value crosses the fabric once per board
+class CinnamonCollective {
+public:
+    enum class Algorithm {
+        Direct,
+        Chain,
+        Ring,
+        Tree
+    };
+    static Algorithm parseAlgorithm(const std::string &algorithm);
+
+    // Syncs with up to threshold.first chips use threshold.second. Larger syncs use algorithm.
+    // chipsPerBoard of 0 treats all chips as one board
+    CinnamonCollective(size_t numChips, Algorithm algorithm, const std::map<size_t, Algorithm> &thresholds, uint64_t chunkSize, size_t chipsPerBoard = 0);
+
+    Algorithm select(size_t syncSize) const;
+
+    // Sends bytes from root to every destination. Returns the time the whole value arrives at each destination
+    std::vector<std::pair<size_t, SimTime_t>> broadcast(CinnamonTopology &topology, Algorithm algorithm, size_t root, const std::vector<size_t> &destinations, uint64_t bytes, SimTime_t start);
+
+    // Reduces the inputs (chip, time the input is available) into root. Returns the time the reduced value is complete
+    SimTime_t reduce(CinnamonTopology &topology, Algorithm algorithm, size_t root, const std::vector<std::pair<size_t, SimTime_t>> &inputs, uint64_t bytes);
+
+    // Exchanges between participants. bytes is the size of the value (all-gather) or of the share (reduce-scatter, all-to-all)
+    // a participant sends to each of the others.
+    // allGather and allToAll send from source, whose input became available at start, and return the arrival at each destination
+    std::vector<std::pair<size_t, SimTime_t>> allGather(CinnamonTopology &topology, Algorithm algorithm, size_t source, const std::vector<size_t> &destinations, uint64_t bytes, SimTime_t start);
+    std::vector<std::pair<size_t, SimTime_t>> allToAll(CinnamonTopology &topology, size_t source, const std::vector<size_t> &destinations, uint64_t bytes, SimTime_t start);
+    // Returns the time each participant's share of the reduced value is complete
+    std::vector<std::pair<size_t, SimTime_t>> reduceScatter(CinnamonTopology &topology, Algorithm algorithm, const std::vector<std::pair<size_t, SimTime_t>> &inputs, uint64_t bytes);
+
+    std::string printStats() const;
+
+private:
+    size_t numChips;
+    Algorithm algorithm;
+    std::map<size_t, Algorithm> thresholds;
+    uint64_t chunkSize;
+    size_t chipsPerBoard;
+
+    // Edges (parent, child) of the tree the algorithm builds, parents before their children
+    std::vector<std::pair<size_t, size_t>> tree(Algorithm algorithm, size_t root, const std::vector<size_t> &participants) const;
+    // Tree over participants ordered by distance(participant), the distance from the root
+    template <typename Distance>
+    std::vector<std::pair<size_t, size_t>> levelTree(Algorithm algorithm, size_t root, std::vector<size_t> participants, Distance distance) const;
+    std::vector<uint64_t> chunks(uint64_t bytes) const;
+    std::vector<std::pair<size_t, SimTime_t>> scheduleBroadcast(CinnamonTopology &topology, Algorithm algorithm, size_t root, const std::vector<size_t> &destinations, uint64_t bytes, SimTime_t start);
+    SimTime_t scheduleReduce(CinnamonTopology &topology, Algorithm algorithm, size_t root, const std::vector<std::pair<size_t, SimTime_t>> &inputs, uint64_t bytes);
+
+    struct Stats {
+        uint64_t broadcasts[4] = {};
+        uint64_t reductions[4] = {};
+        uint64_t allGathers[4] = {};
+        uint64_t reduceScatters[4] = {};
+        uint64_t allToAlls = 0;
+        uint64_t chunkTransfers = 0;
+    } stats_;
+};
+
+} // namespace Cinnamon
+} // namespace SST
+
+#endif // _H_SST_CINNAMON_COLLECTIVE
@@ -11,6 +11,20 @@
 namespace SST {
 namespace Cinnamon {
 
+namespace {
+// Start of an element-wise instruction whose operands are still being streamed in, when it can start at currentCycle
+std::optional<CinnamonInstruction::StreamedStart> streamedStart(const CinnamonInstruction &instruction, SST::Cycle_t readCycles, SST::Cycle_t currentCycle) {
+    if (instruction.allOperandsReady()) {
+        return std::nullopt;
+    }
+    auto streamed = instruction.streamedStart(readCycles);
+    if (!streamed || streamed->start > currentCycle) {
+        return std::nullopt;
+    }
+    return streamed;
+}
+} // namespace
+
 CinnamonAddQueue::CinnamonAddQueue(CinnamonChip *pe, const std::string &name, const uint32_t outputLevel, const Latency &latency, const FuVector &addUnits) : pe(pe), name(name), latency(latency), addUnits(addUnits), CinnamonInstructionQueue() {
     output = std::make_shared<SST::Output>(SST::Output(name + "[@p:@l]: ", outputLevel, 0, SST::Output::STDOUT));
 }
@@ -40,12 +54,14 @@ void CinnamonAddQueue::tick(SST::Cycle_t currentCycle) {
     auto it = instructionQueue.begin();
     for (; it != instructionQueue.end();) {
         auto &instruction = *it;
-        if (instruction->allOperandsReady()) {
+        const SST::Cycle_t readCycles = VEC_DEPTH * instruction->limbGroupSize();
+        auto streamed = streamedStart(*instruction, readCycles, currentCycle);
+        if (instruction->allOperandsReady() || streamed) {
 
             // TODO: Reserve Register File too...
 
             SST::Cycle_t start = currentCycle;
-            SST::Cycle_t end = currentCycle + VEC_DEPTH - 1;
+            SST::Cycle_t end = currentCycle + readCycles - 1;
             CinnamonInstructionInterval interval(start, end, instruction);
 
             bool instructionDispatched = false;
@@ -60,6 +76,9 @@ void CinnamonAddQueue::tick(SST::Cycle_t currentCycle) {
             if (!instructionDispatched) {
                 return;
             } else {
+                if (streamed) {
+                    pe->recordStreamedStart(streamed->complete > currentCycle ? streamed->complete - currentCycle : 0);
+                }
                 it = instructionQueue.erase(it);
             }
         } else {
@@ -101,9 +120,11 @@ void CinnamonMulQueue::tick(SST::Cycle_t currentCycle) {
     auto it = instructionQueue.begin();
     for (; it != instructionQueue.end();) {
         auto &instruction = *it;
-        if (instruction->allOperandsReady()) {
+        const SST::Cycle_t readCycles = VEC_DEPTH * instruction->limbGroupSize();
+        auto streamed = streamedStart(*instruction, readCycles, currentCycle);
+        if (instruction->allOperandsReady() || streamed) {
             SST::Cycle_t start = currentCycle;
-            SST::Cycle_t end = currentCycle + VEC_DEPTH - 1 + latency.Mul;
+            SST::Cycle_t end = currentCycle + readCycles - 1 + latency.Mul;
             CinnamonInstructionInterval interval(start, end, instruction);
 
             bool instructionDispatched = false;
@@ -118,6 +139,9 @@ void CinnamonMulQueue::tick(SST::Cycle_t currentCycle) {
             if (!instructionDispatched) {
                 return;
             } else {
+                if (streamed) {
+                    pe->recordStreamedStart(streamed->complete > currentCycle ? streamed->complete - currentCycle : 0);
+                }
                 it = instructionQueue.erase(it);
             }
         } else {
@@ -935,7 +959,7 @@ bool CinnamonModQueue::okayToFinish() {
 
 //###########################################
 
-CinnamonDisQueue::CinnamonDisQueue(CinnamonChip *pe, CinnamonAccelerator *accelerator, const std::string &name, const uint32_t outputLevel, CinnamonNetwork *network, Link *networkLink) : pe(pe), accelerator(accelerator), network(network), networkLink(networkLink), name(name), syncRegistered(false), CinnamonInstructionQueue() {
+CinnamonDisQueue::CinnamonDisQueue(CinnamonChip *pe, CinnamonAccelerator *accelerator, const std::string &name, const uint32_t outputLevel, CinnamonNetwork *network, Link *networkLink, const Config &config) : pe(pe), accelerator(accelerator), network(network), networkLink(networkLink), name(name), config(config), syncRegistered(false), CinnamonInstructionQueue() {
     output = std::make_shared<SST::Output>(SST::Output(name + "[@p:@l]: ", outputLevel, 0, SST::Output::STDOUT));
     networkLink->setFunctor(new Event::Handler<CinnamonDisQueue>(this, &CinnamonDisQueue::handle_incoming));
 }
@@ -947,6 +971,9 @@ void CinnamonDisQueue::addToInstructionQueue(std::shared_ptr<CinnamonInstruction
     case OpCode::Rcv:
     case OpCode::Dis:
     case OpCode::Joi:
+    case OpCode::Agt:
+    case OpCode::Rsc:
+    case OpCode::Ata:
         break;
     default:
         assert(0);
@@ -954,111 +981,281 @@ void CinnamonDisQueue::addToInstructionQueue(std::shared_ptr<CinnamonInstruction
     instructionQueue.emplace_back(instruction);
 }
 
-void CinnamonDisQueue::handle_dis(std::shared_ptr<CinnamonDisInstruction> &instruction) {
-    auto networkEvent = std::make_unique<CinnamonNetworkEvent>(instruction->syncID());
-    networkLink->send(networkEvent.release());
-    instruction->setExecutionComplete();
-    busyWith = nullptr;
-    syncRegistered = false;
+uint64_t CinnamonDisQueue::transferBytes(const CinnamonDisInstruction &instruction) const {
+    using OpCode = CinnamonInstruction::OpCode;
+    const uint64_t others = instruction.syncSize() > 0 ? instruction.syncSize() - 1 : 0;
+    switch (instruction.getOpCode()) {
+    case OpCode::Agt:
+        return others * instruction.bytes();
+    case OpCode::Rsc:
+    case OpCode::Ata:
+        return others * ((instruction.bytes() + instruction.syncSize() - 1) / instruction.syncSize());
+    default:
+        return instruction.bytes();
+    }
 }
 
-void CinnamonDisQueue::handle_joi(std::shared_ptr<CinnamonDisInstruction> &instruction) {
+SST::Cycle_t CinnamonDisQueue::portCycles(uint64_t bytes, uint64_t width) {
+    return width == 0 ? 0 : (bytes + width - 1) / width;
+}
+
+void CinnamonDisQueue::inject(std::shared_ptr<CinnamonDisInstruction> &instruction, SST::Cycle_t currentCycle) {
+    auto cycles = portCycles(transferBytes(*instruction), config.injectionWidth);
+    auto start = std::max(currentCycle, injectionFreeAt);
+    injectionFreeAt = start + cycles;
+    stats_.injectionBusyCycles += cycles;
+    injecting.push_back(PortTransfer{injectionFreeAt, instruction});
+}
+
+void CinnamonDisQueue::sendToNetwork(std::shared_ptr<CinnamonDisInstruction> &instruction) {
     auto networkEvent = std::make_unique<CinnamonNetworkEvent>(instruction->syncID());
-    if (instruction->hasSource() == true) {
-        networkLink->send(networkEvent.release());
-        output->verbose(CALL_INFO, 4, 0, "%s: %lu Queue:%s Sending to network instruction: %s\n", pe->getName().c_str(), accelerator->getCurrentSimTime(), name.c_str(), busyWith->getString().c_str());
-    }
+    networkLink->send(networkEvent.release());
+    output->verbose(CALL_INFO, 4, 0, "%s: %lu Queue:%s Sending to network instruction: %s\n", pe->getName().c_str(), accelerator->getCurrentSimTime(), name.c_str(), instruction->getString().c_str());
     if (instruction->hasDest() == false) {
-        // This instruction only sends data on the network, so we can mark the instruction as complete now
-        instruction->setExecutionComplete();
-        busyWith = nullptr;
-        syncRegistered = false;
+        // This instruction only sends data on the network, so it is complete once its value has been injected
+        complete(instruction);
     }
 }
 
+void CinnamonDisQueue::complete(std::shared_ptr<CinnamonDisInstruction> instruction) {
+    instruction->setExecutionComplete();
+    outstanding.erase(instruction->syncID());
+}
+
 void CinnamonDisQueue::handle_incoming(SST::Event *ev) {
     std::unique_ptr<CinnamonNetworkEvent> networkEvent(static_cast<CinnamonNetworkEvent *>(ev));
-    if (!busyWith) {
-        output->fatal(CALL_INFO, -1, "%s: %lu Received Spurious Response\n", pe->getName().c_str(), accelerator->getCurrentSimTime());
+    auto it = outstanding.find(networkEvent->syncID());
+    if (it == outstanding.end()) {
+        output->fatal(CALL_INFO, -1, "%s: %lu Received Spurious Response for syncID: %lu\n", pe->getName().c_str(), accelerator->getCurrentSimTime(), networkEvent->syncID());
     }
-    if (networkEvent->syncID() != busyWith->syncID()) {
-        output->fatal(CALL_INFO, -1, "%s: %lu Received Response With mismatching syncID. Expected: %lu, Got: %lu\n", pe->getName().c_str(), accelerator->getCurrentSimTime(), networkEvent->syncID(), busyWith->syncID());
+    auto instruction = it->second;
+    if (!instruction->hasDest()) {
+        output->fatal(CALL_INFO, -1, "%s: %lu Received Response for send only instruction: %s\n", pe->getName().c_str(), accelerator->getCurrentSimTime(), instruction->getString().c_str());
+    }
+    output->verbose(CALL_INFO, 4, 0, "%s: %lu Queue:%s received Response for instruction: %s\n", pe->getName().c_str(), accelerator->getCurrentSimTime(), name.c_str(), instruction->getString().c_str());
+    if (config.ejectionWidth == 0) {
+        complete(instruction);
+    } else {
+        // The ejection port is scheduled on the next tick, which knows the current cycle
+        arrived.push_back(instruction);
     }
-    output->verbose(CALL_INFO, 4, 0, "%s: %lu Queue:%s received Response for instruction: %s\n", pe->getName().c_str(), accelerator->getCurrentSimTime(), name.c_str(), busyWith->getString().c_str());
-    busyWith->setExecutionComplete();
-    busyWith = nullptr;
-    syncRegistered = false;
 }
 
 void CinnamonDisQueue::tick(SST::Cycle_t currentCycle) {
     stats_.totalCycles++;
-    using OpCode = CinnamonInstruction::OpCode;
-    if (busyWith == nullptr) {
-        if (instructionQueue.empty()) {
-            if (QUEUE_EMPTY) {
-                output->verbose(CALL_INFO, 4, 0, "%s: %lu Queue:%s Empty\n", pe->getName().c_str(), currentCycle, name.c_str());
-            }
-            return;
+
+    // Results are ejected one after the other at the ejection width
+    for (auto &instruction : arrived) {
+        auto cycles = portCycles(transferBytes(*instruction), config.ejectionWidth);
+        auto start = std::max(currentCycle, ejectionFreeAt);
+        ejectionFreeAt = start + cycles;
+        stats_.ejectionBusyCycles += cycles;
+        if (config.streamChunkBytes != 0 && instruction->hasDest()) {
+            // Element-wise consumers may start on the chunks already written
+            auto bytes = transferBytes(*instruction);
+            instruction->streamResult(start, ejectionFreeAt, std::max<uint64_t>((bytes + config.streamChunkBytes - 1) / config.streamChunkBytes, 1));
+            stats_.streamedResults++;
         }
+        ejecting.push_back(PortTransfer{ejectionFreeAt, instruction});
+    }
+    arrived.clear();
+    while (!ejecting.empty() && ejecting.front().done <= currentCycle) {
+        complete(ejecting.front().instruction);
+        ejecting.pop_front();
+    }
 
-        auto it = instructionQueue.begin();
+    if (!outstanding.empty()) {
+        stats_.busyCycles++;
+        if (outstanding.size() > 1) {
+            stats_.overlappedCycles++;
+        }
+    }
 
-        auto instruction = std::dynamic_pointer_cast<CinnamonDisInstruction>(*it);
-        assert(instruction);
+    issue(currentCycle);
 
-        if (!instruction->allOperandsReady()) {
-            return;
-        }
+    while (!injecting.empty() && injecting.front().done <= currentCycle) {
+        sendToNetwork(injecting.front().instruction);
+        injecting.pop_front();
+    }
+}
 
-        auto syncID = instruction->syncID();
-        auto syncSize = instruction->syncSize();
-
-        if (!syncRegistered) {
-            CinnamonNetwork::OpType opType;
-            switch (instruction->getOpCode()) {
-            case OpCode::Rcv:
-            case OpCode::Dis:
-                opType = CinnamonNetwork::OpType::Brc;
-                break;
-            case OpCode::Joi:
-                opType = CinnamonNetwork::OpType::Agg;
-                break;
-            default:
-                throw std::runtime_error("Invalid Instruciton for Network : " + instruction->getString());
-                break;
-            }
-            syncRegistered = network->tryRegisterSync(pe->chipID(), syncID, syncSize, opType, instruction->hasDest(), instruction->hasSource());
-            if (syncRegistered) {
-                output->verbose(CALL_INFO, 4, 0, "%s: %lu Queue:%s Registerd Sync for Instruction: %s\n", pe->getName().c_str(), currentCycle, name.c_str(), instruction->getString().c_str());
-            }
+void CinnamonDisQueue::issue(SST::Cycle_t currentCycle) {
+    using OpCode = CinnamonInstruction::OpCode;
+    if (instructionQueue.empty()) {
+        if (QUEUE_EMPTY) {
+            output->verbose(CALL_INFO, 4, 0, "%s: %lu Queue:%s Empty\n", pe->getName().c_str(), currentCycle, name.c_str());
         }
+        return;
+    }
+    if (outstanding.size() >= config.maxOutstanding) {
+        stats_.outstandingLimitCycles++;
+        return;
+    }
+
+    auto it = instructionQueue.begin();
+
+    auto instruction = std::dynamic_pointer_cast<CinnamonDisInstruction>(*it);
+    assert(instruction);
 
-        bool networkReady = network->networkReady(syncID);
-        if (!networkReady) {
-            stats_.waitingForNetworkCycles++;
-            return;
+    if (!instruction->allOperandsReady()) {
+        return;
+    }
+
+    auto syncID = instruction->syncID();
+    auto syncSize = instruction->syncSize();
+    if (outstanding.count(syncID)) {
+        // Completions are matched by syncID, so a chip takes part in a sync once at a time
+        return;
+    }
+
+    if (!syncRegistered) {
+        CinnamonNetwork::OpType opType;
+        switch (instruction->getOpCode()) {
+        case OpCode::Rcv:
+        case OpCode::Dis:
+            opType = CinnamonNetwork::OpType::Brc;
+            break;
+        case OpCode::Joi:
+            opType = CinnamonNetwork::OpType::Agg;
+            break;
+        case OpCode::Agt:
+            opType = CinnamonNetwork::OpType::AllGather;
+            break;
+        case OpCode::Rsc:
+            opType = CinnamonNetwork::OpType::ReduceScatter;
+            break;
+        case OpCode::Ata:
+            opType = CinnamonNetwork::OpType::AllToAll;
+            break;
+        default:
+            throw std::runtime_error("Invalid Instruciton for Network : " + instruction->getString());
+            break;
+        }
+        syncRegistered = network->tryRegisterSync(pe->chipID(), syncID, syncSize, instruction->bytes(), opType, instruction->hasDest(), instruction->hasSource());
+        if (syncRegistered) {
+            output->verbose(CALL_INFO, 4, 0, "%s: %lu Queue:%s Registerd Sync for Instruction: %s\n", pe->getName().c_str(), currentCycle, name.c_str(), instruction->getString().c_str());
         }
+    }
 
-        busyWith = instruction;
-        it = instructionQueue.erase(it);
+    bool networkReady = network->networkReady(syncID);
+    if (!networkReady) {
+        stats_.waitingForNetworkCycles++;
+        return;
+    }
 
-        output->verbose(CALL_INFO, 4, 0, "%s: %lu Queue:%s Network ready for Instruction: %s\n", pe->getName().c_str(), currentCycle, name.c_str(), instruction->getString().c_str());
-        if (instruction->getOpCode() == OpCode::Dis) {
-            handle_dis(instruction);
-        } else if (instruction->getOpCode() == OpCode::Rcv) {
-            ;
-        } else if (instruction->getOpCode() == OpCode::Joi) {
-            handle_joi(instruction);
-        } else {
-            throw std::runtime_error("Invalid OpCode For network instruction: " + instruction->getString());
+    outstanding[syncID] = instruction;
+    instructionQueue.erase(it);
+    syncRegistered = false;
+    stats_.issued++;
+    stats_.maxOutstanding = std::max(stats_.maxOutstanding, outstanding.size());
+
+    output->verbose(CALL_INFO, 4, 0, "%s: %lu Queue:%s Network ready for Instruction: %s\n", pe->getName().c_str(), currentCycle, name.c_str(), instruction->getString().c_str());
+    switch (instruction->getOpCode()) {
+    case OpCode::Rcv:
+        break;
+    case OpCode::Dis:
+    case OpCode::Joi:
+    case OpCode::Agt:
+    case OpCode::Rsc:
+    case OpCode::Ata:
+        if (instruction->hasSource()) {
+            inject(instruction, currentCycle);
         }
-    } else if (busyWith != nullptr) {
-        stats_.busyCycles++;
+        break;
+    default:
+        throw std::runtime_error("Invalid OpCode For network instruction: " + instruction->getString());
     }
 }
 
+void CinnamonDisQueue::recordStreamedStart(SST::Cycle_t savedCycles) {
+    stats_.streamedStarts++;
+    stats_.streamedCyclesSaved += savedCycles;
+}
+
 bool CinnamonDisQueue::okayToFinish() {
-    return instructionQueue.empty();
+    return instructionQueue.empty() && outstanding.empty() && injecting.empty() && arrived.empty() && ejecting.empty();
+}
+
+std::string CinnamonDisQueue::printStats() const {
+    std::stringstream s;
+    s << "Network Queue: " << name << "\n";
+    s << "\tTotal Cycles: " << stats_.totalCycles << "\n";
+    s << "\tBusy Cycles: " << stats_.busyCycles << "\n";
+    s << "\tOverlapped Cycles: " << stats_.overlappedCycles << "\n";
+    s << "\tWaiting For Network Cycles: " << stats_.waitingForNetworkCycles << "\n";
+    s << "\tOutstanding Limit Cycles: " << stats_.outstandingLimitCycles << "\n";
+    s << "\tInstructions Issued: " << stats_.issued << "\n";
+    s << "\tMax Outstanding: " << stats_.maxOutstanding << " of " << config.maxOutstanding << "\n";
+    s << "\tInjection Busy Cycles: " << stats_.injectionBusyCycles << "\n";
+    s << "\tEjection Busy Cycles: " << stats_.ejectionBusyCycles << "\n";
+    if (config.streamChunkBytes != 0) {
+        s << "\tStreamed Results: " << stats_.streamedResults << "\n";
+        s << "\tConsumers Started On Partial Results: " << stats_.streamedStarts << "\n";
+        s << "\tConsumer Cycles Saved By Streaming: " << stats_.streamedCyclesSaved << "\n";
+    }
+    return s.str();
+}
+
+//###########################################
+
+CinnamonFastForwardQueue::CinnamonFastForwardQueue(CinnamonChip *pe, const std::string &name, const uint32_t outputLevel) : CinnamonInstructionQueue(), pe(pe), name(name) {
+    output = std::make_shared<SST::Output>(SST::Output(name + "[@p:@l]: ", outputLevel, 0, SST::Output::STDOUT));
+}
+
+void CinnamonFastForwardQueue::addToInstructionQueue(std::shared_ptr<CinnamonInstruction> instruction) {
+
+    using OpCode = CinnamonInstruction::OpCode;
+    if (instruction->getOpCode() == OpCode::Bci) {
+        // The base conversion stays open until all its reads and writes have been performed
+        auto bci = std::dynamic_pointer_cast<CinnamonBciInstruction>(instruction);
+        assert(bci);
+        bci->setPhyiscalBaseConversionRegister(0);
+        openBaseConversions.emplace_back(bci);
+    } else {
+        instructionQueue.emplace_back(instruction);
+    }
+    drain();
+}
+
+void CinnamonFastForwardQueue::drain() {
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        for (auto it = instructionQueue.begin(); it != instructionQueue.end();) {
+            auto &instruction = *it;
+            if (instruction->allOperandsReady()) {
+                output->verbose(CALL_INFO, 4, 0, "%s: Queue:%s Fast-forwarding Instruction: %s\n", pe->getName().c_str(), name.c_str(), instruction->getString().c_str());
+                instruction->setExecutionComplete();
+                if (auto memory = std::dynamic_pointer_cast<CinnamonMemoryInstruction>(instruction)) {
+                    pe->releaseMemoryInstruction(*memory);
+                }
+                it = instructionQueue.erase(it);
+                progress = true;
+            } else {
+                it++;
+            }
+        }
+        for (auto it = openBaseConversions.begin(); it != openBaseConversions.end();) {
+            if ((*it)->isCompleted()) {
+                (*it)->setExecutionComplete();
+                it = openBaseConversions.erase(it);
+                progress = true;
+            } else {
+                it++;
+            }
+        }
+    }
+}
+
+void CinnamonFastForwardQueue::tick(SST::Cycle_t) {
+    if (instructionQueue.empty() && openBaseConversions.empty()) {
+        return;
+    }
+    drain();
+}
+
+bool CinnamonFastForwardQueue::okayToFinish() {
+    return instructionQueue.empty() && openBaseConversions.empty();
 }
 
 //###########################################
@@ -1130,6 +1327,18 @@ void CinnamonFunctionalUnit::addReservation(const CinnamonInstructionInterval &i
     output->fatal(CALL_INFO, -1, "Error: Reservation for interval: %s could not be made. Some thing is terribly wrong\n", interval.getString().c_str());
 }
 
+SST::Cycle_t CinnamonFunctionalUnit::reservedUntil() const {
+    if (reservations.empty()) {
+        return 0;
+    }
+    return reservations.back().end();
+}
+
+void CinnamonFunctionalUnit::addReplayedCycles(SST::Cycle_t busyCycles, SST::Cycle_t issueCycles) {
+    stats_.busyCycles += busyCycles;
+    stats_.issueCycles += issueCycles;
+}
+
 void CinnamonFunctionalUnit::executeCycleBegin(SST::Cycle_t currentCycle) {
 
     if (currentCycle % 100000 == 0) {
@@ -1168,7 +1377,11 @@ void CinnamonFunctionalUnit::executeCycleBegin(SST::Cycle_t currentCycle) {
     output->verbose(CALL_INFO, 4, 0, "%s: %lu Executing Instruction: %s with Interval: %s\n",
                     pe->getName().c_str(), currentCycle, instruction->getString().c_str(), interval.getString().c_str());
 
-    if (instruction->allOperandsReady() != true) {
+    // A limb group streams its limbs back to back through the unit
+    const SST::Cycle_t limbs = instruction->limbGroupSize();
+
+    // Element-wise consumers are reserved while their operands are still being streamed in
+    if (instruction->allOperandsReady() != true && !streamedStart(*instruction, VEC_DEPTH * limbs, currentCycle)) {
         output->fatal(CALL_INFO, -1, "ERROR: Instruction %s not ready at cycle: %" PRIu64 ".\n", instruction->getString().c_str(), currentCycle);
     }
 
@@ -1176,12 +1389,12 @@ void CinnamonFunctionalUnit::executeCycleBegin(SST::Cycle_t currentCycle) {
         output->fatal(CALL_INFO, -1, "ERROR: Instruction %s cannoth be issued at cycle: %" PRIu64 ".\n", instruction->getString().c_str(), currentCycle);
     }
 
-    busyWith.emplace_back(std::make_pair(instruction, latency));
-    stats_.issueCycles += (vecDepth);
-    stats_.issueCyclesWindow += (vecDepth);
-    consumingCycles = (vecDepth);
+    busyWith.emplace_back(std::make_pair(instruction, latency + vecDepth * (limbs - 1)));
+    stats_.issueCycles += (vecDepth * limbs);
+    stats_.issueCyclesWindow += (vecDepth * limbs);
+    consumingCycles = (vecDepth * limbs);
 
-    inProcess.emplace_back(std::make_pair(instruction, latency + VEC_DEPTH - 1));
+    inProcess.emplace_back(std::make_pair(instruction, latency + VEC_DEPTH * limbs - 1));
 }
 
 bool CinnamonFunctionalUnit::okayToFinish() {
@@ -2,7 +2,9 @@
 #ifndef _H_SST_CINNAMON_FUNCTIONALUNIT
 #define _H_SST_CINNAMON_FUNCTIONALUNIT
 
+#include <deque>
 #include <list>
+#include <map>
 #include <queue>
 
 #include "instruction.h"
@@ -52,6 +54,19 @@ public:
     bool okayToFinish();
     bool isIntervalReservable(const CinnamonInstructionInterval &);
     void addReservation(const CinnamonInstructionInterval &interval);
+    const std::string &getName() const {
+        return name;
+    }
+    // Last cycle for which the unit holds a reservation
+    SST::Cycle_t reservedUntil() const;
+    SST::Cycle_t busyCycles() const {
+        return stats_.busyCycles;
+    }
+    SST::Cycle_t issueCycles() const {
+        return stats_.issueCycles;
+    }
+    // Accounts for activity that was not simulated cycle by cycle
+    void addReplayedCycles(SST::Cycle_t busyCycles, SST::Cycle_t issueCycles);
     std::string printStats();
 };
 
@@ -84,6 +99,8 @@ public:
     virtual void addToInstructionQueue(std::shared_ptr<CinnamonInstruction> instruction) = 0;
     virtual void tick(SST::Cycle_t currentCycle) = 0;
     virtual bool okayToFinish() = 0;
+    // Number of instructions waiting in the queue
+    virtual std::size_t size() const = 0;
     virtual ~CinnamonInstructionQueue() = default;
 
 protected:
@@ -104,6 +121,9 @@ public:
     void addToInstructionQueue(std::shared_ptr<CinnamonInstruction> instruction) override;
     void tick(SST::Cycle_t currentCycle) override;
     bool okayToFinish() override;
+    std::size_t size() const override {
+        return instructionQueue.size();
+    }
 
     // TODO: Add destructor
 };
@@ -121,6 +141,9 @@ public:
     void addToInstructionQueue(std::shared_ptr<CinnamonInstruction> instruction) override;
     void tick(SST::Cycle_t currentCycle) override;
     bool okayToFinish() override;
+    std::size_t size() const override {
+        return instructionQueue.size();
+    }
 
     // TODO: Add destructor
 };
@@ -138,6 +161,9 @@ public:
     void addToInstructionQueue(std::shared_ptr<CinnamonInstruction> instruction) override;
     void tick(SST::Cycle_t currentCycle) override;
     bool okayToFinish() override;
+    std::size_t size() const override {
+        return instructionQueue.size();
+    }
 
     // TODO: Add destructor
 };
@@ -158,6 +184,9 @@ public:
     void addToInstructionQueue(std::shared_ptr<CinnamonInstruction> instruction) override;
     void tick(SST::Cycle_t currentCycle) override;
     bool okayToFinish() override;
+    std::size_t size() const override {
+        return instructionQueue.size();
+    }
 
     // TODO: Add destructor
 };
@@ -179,6 +208,9 @@ public:
     void addToInstructionQueue(std::shared_ptr<CinnamonInstruction> instruction) override;
     void tick(SST::Cycle_t currentCycle) override;
     bool okayToFinish() override;
+    std::size_t size() const override {
+        return instructionQueue.size();
+    }
 
     // TODO: Add destructor
 };
@@ -200,6 +232,9 @@ public:
     void addToInstructionQueue(std::shared_ptr<CinnamonInstruction> instruction) override;
     void tick(SST::Cycle_t currentCycle) override;
     bool okayToFinish() override;
+    std::size_t size() const override {
+        return instructionQueue.size();
+    }
 
     // TODO: Add destructor
 };
@@ -216,6 +251,9 @@ public:
     void addToInstructionQueue(std::shared_ptr<CinnamonInstruction> instruction) override;
     void tick(SST::Cycle_t currentCycle) override;
     bool okayToFinish() override;
+    std::size_t size() const override {
+        return instructionQueue.size();
+    }
 
     // TODO: Add destructor
 };
@@ -235,6 +273,9 @@ public:
     void addToInstructionQueue(std::shared_ptr<CinnamonInstruction> instruction) override;
     void tick(SST::Cycle_t currentCycle) override;
     bool okayToFinish() override;
+    std::size_t size() const override {
+        return instructionQueue.size();
+    }
 
     // TODO: Add destructor
 };
@@ -253,6 +294,9 @@ public:
     void addToInstructionQueue(std::shared_ptr<CinnamonInstruction> instruction) override;
     void tick(SST::Cycle_t currentCycle) override;
     bool okayToFinish() override;
+    std::size_t size() const override {
+        return instructionQueue.size();
+    }
 
     // TODO: Add destructor
 };
@@ -273,6 +317,9 @@ public:
     void addToInstructionQueue(std::shared_ptr<CinnamonInstruction> instruction) override;
     void tick(SST::Cycle_t currentCycle) override;
     bool okayToFinish() override;
+    std::size_t size() const override {
+        return instructionQueue.size();
+    }
 
     // TODO: Add destructor
 };
@@ -293,6 +340,9 @@ public:
     void addToInstructionQueue(std::shared_ptr<CinnamonInstruction> instruction) override;
     void tick(SST::Cycle_t currentCycle) override;
     bool okayToFinish() override;
+    std::size_t size() const override {
+        return instructionQueue.size();
+    }
 
     // TODO: Add destructor
 };
@@ -314,6 +364,9 @@ public:
     void addToInstructionQueue(std::shared_ptr<CinnamonInstruction> instruction) override;
     void tick(SST::Cycle_t currentCycle) override;
     bool okayToFinish() override;
+    std::size_t size() const override {
+        return instructionQueue.size();
+    }
 
     // TODO: Add destructor
 };
@@ -331,6 +384,9 @@ public:
     void addToInstructionQueue(std::shared_ptr<CinnamonInstruction> instruction) override;
     void tick(SST::Cycle_t currentCycle) override;
     bool okayToFinish() override;
+    std::size_t size() const override {
+        return instructionQueue.size();
+    }
 
     // TODO: Add destructor
 };
@@ -348,11 +404,27 @@ public:
     void addToInstructionQueue(std::shared_ptr<CinnamonInstruction> instruction) override;
     void tick(SST::Cycle_t currentCycle) override;
     bool okayToFinish() override;
+    std::size_t size() const override {
+        return instructionQueue.size();
+    }
 
     // TODO: Add destructor
 };
 
+// Issues network instructions in order. Up to maxOutstanding syncs can be in flight at once, their results are
+// matched by syncID. Values leave the chip through an injection port and results enter it through an ejection
+// port, each moving the given number of bytes per cycle. A width of 0 moves a value in no time
 class CinnamonDisQueue : public CinnamonInstructionQueue {
+public:
+    struct Config {
+        size_t maxOutstanding = 1;
+        uint64_t injectionWidth = 0;
+        uint64_t ejectionWidth = 0;
+        // Results are written into their register in chunks of this many bytes as they leave the ejection port. 0 writes them whole
+        uint64_t streamChunkBytes = 0;
+    };
+
+private:
     CinnamonNetwork *network;
     Link *networkLink;
     CinnamonChip *pe;
@@ -360,30 +432,115 @@ class CinnamonDisQueue : public CinnamonInstructionQueue {
     std::string name;
     std::shared_ptr<SST::Output> output;
     std::list<std::shared_ptr<CinnamonInstruction>> instructionQueue;
+    Config config;
 
+    // The instruction at the head of the queue has registered its sync
     bool syncRegistered;
-    std::shared_ptr<CinnamonDisInstruction> busyWith;
-
-    void handle_dis(std::shared_ptr<CinnamonDisInstruction> &instruction);
-    void handle_joi(std::shared_ptr<CinnamonDisInstruction> &instruction);
+    std::map<uint64_t, std::shared_ptr<CinnamonDisInstruction>> outstanding;
+
+    struct PortTransfer {
+        SST::Cycle_t done;
+        std::shared_ptr<CinnamonDisInstruction> instruction;
+    };
+    std::deque<PortTransfer> injecting;
+    std::deque<PortTransfer> ejecting;
+    // Results received from the network that have not been scheduled on the ejection port yet
+    std::vector<std::shared_ptr<CinnamonDisInstruction>> arrived;
+    SST::Cycle_t injectionFreeAt = 0;
+    SST::Cycle_t ejectionFreeAt = 0;
+
+    void issue(SST::Cycle_t currentCycle);
+    void inject(std::shared_ptr<CinnamonDisInstruction> &instruction, SST::Cycle_t currentCycle);
+    void sendToNetwork(std::shared_ptr<CinnamonDisInstruction> &instruction);
+    void complete(std::shared_ptr<CinnamonDisInstruction> instruction);
     void handle_incoming(SST::Event *ev);
+    // Bytes the chip sends (and receives) for an instruction
+    uint64_t transferBytes(const CinnamonDisInstruction &instruction) const;
+    static SST::Cycle_t portCycles(uint64_t bytes, uint64_t width);
 
     struct Stats {
         SST::Cycle_t totalCycles = 0;
         SST::Cycle_t busyCycles = 0;
         SST::Cycle_t waitingForNetworkCycles = 0;
-
+        SST::Cycle_t overlappedCycles = 0;
+        SST::Cycle_t outstandingLimitCycles = 0;
+        SST::Cycle_t injectionBusyCycles = 0;
+        SST::Cycle_t ejectionBusyCycles = 0;
+        uint64_t issued = 0;
+        size_t maxOutstanding = 0;
+        uint64_t streamedResults = 0;
+        uint64_t streamedStarts = 0;
+        SST::Cycle_t streamedCyclesSaved = 0;
     } stats_;
 
 public:
-    CinnamonDisQueue(CinnamonChip *pe, CinnamonAccelerator *accelerator, const std::string &name, const uint32_t outputLevel, CinnamonNetwork *network, Link *networkLink);
+    CinnamonDisQueue(CinnamonChip *pe, CinnamonAccelerator *accelerator, const std::string &name, const uint32_t outputLevel, CinnamonNetwork *network, Link *networkLink, const Config &config);
     void addToInstructionQueue(std::shared_ptr<CinnamonInstruction> instruction) override;
     void tick(SST::Cycle_t currentCycle) override;
     bool okayToFinish() override;
+    std::size_t size() const override {
+        return instructionQueue.size();
+    }
+    std::string printStats() const;
+    // A consumer started savedCycles before the streamed result it reads was complete
+    void recordStreamedStart(SST::Cycle_t savedCycles);
 
     // TODO: Add destructor
 };
 
+// Completes instructions functionally. Results are produced as soon as the operands are ready without
+// reserving functional units or issuing memory traffic. Used for instructions whose timing is not simulated
+class CinnamonFastForwardQueue : public CinnamonInstructionQueue {
+    CinnamonChip *pe;
+    std::string name;
+    std::shared_ptr<SST::Output> output;
+    std::list<std::shared_ptr<CinnamonInstruction>> instructionQueue;
+    std::list<std::shared_ptr<CinnamonBciInstruction>> openBaseConversions;
+
+    void drain();
+
+public:
+    CinnamonFastForwardQueue(CinnamonChip *pe, const std::string &name, const uint32_t outputLevel);
+    void addToInstructionQueue(std::shared_ptr<CinnamonInstruction> instruction) override;
+    void tick(SST::Cycle_t currentCycle) override;
+    bool okayToFinish() override;
+    std::size_t size() const override {
+        return instructionQueue.size() + openBaseConversions.size();
+    }
+};
+
+// Collects the instructions of a limb group while they are dispatched. The chip issues the collected
+// instructions to the target queue as one macro-instruction once the whole group has been dispatched
+class CinnamonLimbGroupQueue : public CinnamonInstructionQueue {
+    CinnamonInstructionQueue *target = nullptr;
+    std::vector<std::shared_ptr<CinnamonInstruction>> members;
+
+public:
+    void addToInstructionQueue(std::shared_ptr<CinnamonInstruction> instruction) override {
+        members.push_back(instruction);
+    }
+    void tick(SST::Cycle_t currentCycle) override {}
+    bool okayToFinish() override {
+        return members.empty();
+    }
+    std::size_t size() const override {
+        return members.size();
+    }
+
+    void setTarget(CinnamonInstructionQueue *queue) {
+        target = queue;
+    }
+    CinnamonInstructionQueue *getTarget() const {
+        return target;
+    }
+    std::vector<std::shared_ptr<CinnamonInstruction>> release() {
+        target = nullptr;
+        auto released = std::move(members);
+        members.clear();
+        return released;
+    }
+};
+
 } // Namespace Cinnamon
 } // Namespace SST
 
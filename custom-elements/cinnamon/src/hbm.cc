@@ -0,0 +1,173 @@
+// Copyright (c) Siddharth Jayashankar. All rights reserved.
+#include "hbm.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <sstream>
+
+namespace SST {
+namespace Cinnamon {
+
+CinnamonHBM::CinnamonHBM(ComponentId_t id, Params &params, TimeConverter *&time, HandlerBase *&handler) : StandardMem(id, params, time, handler), handler(handler) {
+
+    const uint32_t output_level = (uint32_t)params.find<uint32_t>("verbose", 0);
+    output = std::make_shared<SST::Output>(SST::Output("CinnamonHBM[@p:@l]: ", output_level, 0, SST::Output::STDOUT));
+
+    channels = params.find<uint32_t>("channels", 8);
+    banksPerChannel = params.find<uint32_t>("banksPerChannel", 16);
+    interleaveSize = params.find<uint64_t>("interleaveSize", 256);
+    rowBufferModel = params.find<bool>("rowBufferModel", false);
+    rowSize = params.find<uint64_t>("rowSize", 1024);
+    lineSize = params.find<Addr>("lineSize", 64);
+    if (channels == 0 || banksPerChannel == 0 || interleaveSize == 0 || rowSize == 0) {
+        output->fatal(CALL_INFO, -1, "%s: channels, banksPerChannel, interleaveSize and rowSize must be non zero\n", getName().c_str());
+    }
+
+    auto bandwidth = params.find<UnitAlgebra>("bandwidth", "256GB/s");
+    if (!bandwidth.hasUnits("B/s")) {
+        output->fatal(CALL_INFO, -1, "%s: bandwidth must be specified in B/s\n", getName().c_str());
+    }
+    const double channelBytesPerSecond = bandwidth.getDoubleValue() / channels;
+    if (channelBytesPerSecond <= 0) {
+        output->fatal(CALL_INFO, -1, "%s: bandwidth must be positive\n", getName().c_str());
+    }
+    psPerByte = 1e12 / channelBytesPerSecond;
+
+    auto toPs = [&](const std::string &name, const std::string &def) {
+        auto value = params.find<UnitAlgebra>(name, def);
+        if (!value.hasUnits("s")) {
+            output->fatal(CALL_INFO, -1, "%s: %s must be specified in seconds\n", getName().c_str(), name.c_str());
+        }
+        return static_cast<SimTime_t>(std::llround(value.getDoubleValue() * 1e12));
+    };
+    baseLatency = toPs("baseLatency", "100ns");
+    rowMissLatency = toPs("rowMissLatency", "28ns");
+
+    channelBusyUntil.resize(channels, 0);
+    bankReadyAt.resize(channels * banksPerChannel, 0);
+    openRow.resize(channels * banksPerChannel, 0);
+    rowOpen.resize(channels * banksPerChannel, false);
+
+    responseLink = configureSelfLink("response", "1ps", new Event::Handler<CinnamonHBM>(this, &CinnamonHBM::handleResponse));
+
+    output->verbose(CALL_INFO, 1, 0, "%s: %" PRIu32 " channels x %" PRIu32 " banks, %.3f ps/B per channel, base latency %" PRIu64 " ps\n",
+                    getName().c_str(), channels, banksPerChannel, psPerByte, baseLatency);
+}
+
+CinnamonHBM::~CinnamonHBM() {}
+
+void CinnamonHBM::init(unsigned int) {}
+void CinnamonHBM::setup() {}
+void CinnamonHBM::finish() {
+    output->output("%s", printStats().c_str());
+}
+
+double CinnamonHBM::access(Addr addr, uint64_t size, SimTime_t now) {
+    const uint64_t chunksPerRow = std::max<uint64_t>(1, rowSize / interleaveSize);
+    double done = now;
+    Addr end = addr + std::max<uint64_t>(size, 1);
+    while (addr < end) {
+        const uint64_t chunk = addr / interleaveSize;
+        const Addr chunkEnd = std::min<Addr>((chunk + 1) * interleaveSize, end);
+        const uint32_t channel = chunk % channels;
+        const size_t bank = channel * banksPerChannel + (chunk / channels) % banksPerChannel;
+
+        double start = std::max<double>(now, bankReadyAt[bank]);
+        if (rowBufferModel) {
+            const Addr row = (chunk / (uint64_t(channels) * banksPerChannel)) / chunksPerRow;
+            if (rowOpen[bank] && openRow[bank] == row) {
+                stats_.rowHits++;
+            } else {
+                stats_.rowMisses++;
+                start += rowMissLatency;
+                openRow[bank] = row;
+                rowOpen[bank] = true;
+            }
+        }
+        start = std::max(start, channelBusyUntil[channel]);
+        channelBusyUntil[channel] = start + (chunkEnd - addr) * psPerByte;
+        bankReadyAt[bank] = channelBusyUntil[channel];
+        done = std::max(done, channelBusyUntil[channel]);
+        addr = chunkEnd;
+    }
+    return done;
+}
+
+void CinnamonHBM::send(Request *req) {
+    const SimTime_t now = getCurrentSimTime("1ps");
+    if (stats_.reads + stats_.writes == 0) {
+        stats_.firstRequest = now;
+    }
+
+    double done = now;
+    if (auto read = dynamic_cast<Read *>(req)) {
+        stats_.reads++;
+        stats_.bytesRead += read->size;
+        done = access(read->pAddr, read->size, now);
+    } else if (auto write = dynamic_cast<Write *>(req)) {
+        stats_.writes++;
+        stats_.bytesWritten += write->size;
+        done = access(write->pAddr, write->size, now);
+    } else {
+        output->fatal(CALL_INFO, -1, "%s: Unsupported request type: %s\n", getName().c_str(), req->getString().c_str());
+    }
+
+    const SimTime_t latency = static_cast<SimTime_t>(std::ceil(done)) - now + baseLatency;
+    stats_.totalLatency += latency;
+    stats_.lastResponse = std::max(stats_.lastResponse, now + latency);
+    output->verbose(CALL_INFO, 4, 0, "%s: Request %" PRIu64 " completes in %" PRIu64 " ps\n", getName().c_str(), req->getID(), latency);
+
+    if (req->needsResponse()) {
+        responseLink->send(latency, new CinnamonHBMEvent(req->makeResponse()));
+    }
+    delete req;
+}
+
+void CinnamonHBM::handleResponse(Event *ev) {
+    auto event = static_cast<CinnamonHBMEvent *>(ev);
+    (*handler)(event->response());
+    delete event;
+}
+
+Interfaces::StandardMem::Request *CinnamonHBM::poll() {
+    return nullptr;
+}
+
+void CinnamonHBM::sendUntimedData(Request *req) {
+    // Contents are not modelled
+    delete req;
+}
+
+Interfaces::StandardMem::Request *CinnamonHBM::recvUntimedData() {
+    return nullptr;
+}
+
+Interfaces::StandardMem::Addr CinnamonHBM::getLineSize() {
+    return lineSize;
+}
+
+void CinnamonHBM::setMemoryMappedAddressRegion(Addr, Addr) {}
+
+std::string CinnamonHBM::printStats() const {
+    std::stringstream s;
+    const uint64_t requests = stats_.reads + stats_.writes;
+    const SimTime_t active = stats_.lastResponse - stats_.firstRequest;
+    s << "HBM " << getName() << ":\n";
+    s << "\tReads: " << stats_.reads << "\n";
+    s << "\tWrites: " << stats_.writes << "\n";
+    s << "\tBytes Read: " << stats_.bytesRead << "\n";
+    s << "\tBytes Written: " << stats_.bytesWritten << "\n";
+    if (rowBufferModel) {
+        s << "\tRow Hits: " << stats_.rowHits << "\n";
+        s << "\tRow Misses: " << stats_.rowMisses << "\n";
+    }
+    s << "\tAverage Latency (ps): " << (requests ? stats_.totalLatency / requests : 0) << "\n";
+    // Bytes per ps is TB/s
+    s << "\tAchieved Bandwidth (GB/s): " << (active ? 1e3 * double(stats_.bytesRead + stats_.bytesWritten) / active : 0) << "\n";
+    s << "\tPeak Bandwidth (GB/s): " << 1e3 * channels / psPerByte << "\n";
+    return s.str();
+}
+
+} // namespace Cinnamon
+} // namespace SST
@@ -0,0 +1,130 @@
+// Copyright (c) Siddharth Jayashankar. All rights reserved.
+#ifndef _H_SST_CINNAMON_HBM
+#define _H_SST_CINNAMON_HBM
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sst/core/event.h>
+#include <sst/core/interfaces/stdMem.h>
+#include <sst/core/link.h>
+#include <sst/core/output.h>
+#include <sst/core/params.h>
+
+namespace SST {
+namespace Cinnamon {
+
+class CinnamonHBMEvent : public Event {
+public:
+    CinnamonHBMEvent(Interfaces::StandardMem::Request *response) : Event(), response_(response){};
+
+    Interfaces::StandardMem::Request *response() const {
+        return response_;
+    }
+
+private:
+    Interfaces::StandardMem::Request *response_;
+    CinnamonHBMEvent();
+    ImplementSerializable(SST::Cinnamon::CinnamonHBMEvent)
+};
+
+// Analytic HBM timing model that can be loaded into a chip's memory slot in place of memHierarchy.
+// Requests are striped across channels in interleaveSize chunks. Each chunk occupies its channel's
+// data bus for chunkSize / (bandwidth / channels). Banks activate in parallel with transfers on other
+// banks, so with the row buffer model enabled a row miss delays only the chunks of its bank.
+// A response is returned baseLatency after the last chunk of the request leaves its channel.
+// No data is stored; read responses carry zeroed payloads.
+//
+// Calibration against a reference memHierarchy configuration:
+//  1. Run a trace with the reference memHierarchy backend (e.g. memHierarchy.MemController with
+//     a timingDRAM or HBM DRAMSim backend) and note the chip's memory Average Latency and the
+//     completion time of a load only region (`load` lines between roi_begin and roi_end).
+//  2. Set channels and bandwidth to the reference stack's channel count and aggregate peak bandwidth.
+//  3. Set baseLatency so that the unloaded latency of a single memoryRequestWidth request matches
+//     the reference: baseLatency = referenceLatency - memoryRequestWidth / (bandwidth / channels).
+//  4. With rowBufferModel enabled, set rowSize to the reference page size and rowMissLatency to
+//     tRP + tRCD. Then compare the load only region's completion time and adjust bandwidth to the
+//     reference's achieved bandwidth if the two still differ.
+// The model does not capture refresh, bus turnaround or queueing inside the controller, so it should
+// be recalibrated whenever the request size or the read/write mix of the workload changes markedly.
+class CinnamonHBM : public Interfaces::StandardMem {
+public:
+    CinnamonHBM(ComponentId_t id, Params &params, TimeConverter *&time, HandlerBase *&handler);
+    ~CinnamonHBM();
+
+    SST_ELI_REGISTER_SUBCOMPONENT(
+        CinnamonHBM,
+        "cinnamon",
+        "HBM",
+        SST_ELI_ELEMENT_VERSION(1, 0, 0),
+        "Analytic HBM timing model",
+        SST::Interfaces::StandardMem);
+
+    SST_ELI_DOCUMENT_PARAMS(
+        {"verbose", "Verbosity for debugging. Increased numbers for increased verbosity.", "0"},
+        {"channels", "Number of independent channels", "8"},
+        {"banksPerChannel", "Number of banks in each channel", "16"},
+        {"bandwidth", "Aggregate peak bandwidth of all channels", "256GB/s"},
+        {"baseLatency", "Latency added to every request after its data has been transferred", "100ns"},
+        {"interleaveSize", "Size in bytes of the chunks that addresses are striped across channels with", "256"},
+        {"rowBufferModel", "Model an open row per bank. Accesses to another row pay rowMissLatency", "false"},
+        {"rowSize", "Size in bytes of a row", "1024"},
+        {"rowMissLatency", "Latency to close a row and open another (tRP + tRCD)", "28ns"},
+        {"lineSize", "Line size reported to the memory interface", "64"}, )
+
+    void init(unsigned int phase) override;
+    void setup() override;
+    void finish() override;
+
+    void send(Request *req) override;
+    Request *poll() override;
+    void sendUntimedData(Request *req) override;
+    Request *recvUntimedData() override;
+    Addr getLineSize() override;
+    void setMemoryMappedAddressRegion(Addr start, Addr size) override;
+
+private:
+    struct Stats {
+        uint64_t reads = 0;
+        uint64_t writes = 0;
+        uint64_t bytesRead = 0;
+        uint64_t bytesWritten = 0;
+        uint64_t rowHits = 0;
+        uint64_t rowMisses = 0;
+        SimTime_t totalLatency = 0;
+        SimTime_t firstRequest = 0;
+        SimTime_t lastResponse = 0;
+    };
+
+    // Returns the time in ps at which the data of the access has been transferred
+    double access(Addr addr, uint64_t size, SimTime_t now);
+    void handleResponse(Event *ev);
+    std::string printStats() const;
+
+    std::shared_ptr<SST::Output> output;
+    HandlerBase *handler;
+    Link *responseLink;
+
+    uint32_t channels;
+    uint32_t banksPerChannel;
+    double psPerByte; // Per channel
+    SimTime_t baseLatency;
+    uint64_t interleaveSize;
+    bool rowBufferModel;
+    uint64_t rowSize;
+    SimTime_t rowMissLatency;
+    Addr lineSize;
+
+    std::vector<double> channelBusyUntil;
+    std::vector<double> bankReadyAt;
+    std::vector<Addr> openRow;
+    std::vector<bool> rowOpen;
+
+    Stats stats_;
+};
+
+} // namespace Cinnamon
+} // namespace SST
+
+#endif // _H_SST_CINNAMON_HBM
@@ -8,6 +8,8 @@
 #include "sst/core/interfaces/stdMem.h"
 #include <sst/core/component.h>
 
+#include <algorithm>
+#include <optional>
 #include <variant>
 
 namespace SST {
@@ -30,6 +32,17 @@ public:
     virtual bool allOperandsReady() const = 0;
     virtual void setExecutionComplete() = 0;
     virtual std::string getString() const = 0;
+    // Number of limbs processed by the instruction
+    virtual std::uint16_t limbGroupSize() const { return 1; }
+
+    // Cycle an element-wise instruction that reads its operands in order over readCycles cycles can start while some
+    // of them are still being streamed in from the network, and cycle the last of them is complete
+    struct StreamedStart {
+        SST::Cycle_t start = 0;
+        SST::Cycle_t complete = 0;
+    };
+    // Empty unless every operand is ready or being streamed in, or when the instruction cannot consume partial values
+    virtual std::optional<StreamedStart> streamedStart(SST::Cycle_t readCycles) const { return std::nullopt; }
     virtual ~CinnamonInstruction() = default;
 
 protected:
@@ -42,6 +55,13 @@ class CinnamonMemoryInstruction : public CinnamonInstruction {
     Interfaces::StandardMem::Addr addr;
     std::size_t size;
     bool quashed;
+    bool completed = false;
+    // Memory unit bookkeeping
+    uint64_t sequence = 0;
+    SST::Cycle_t queuedCycle = 0;
+    bool deferred = false;
+    // Transfers of other limbs performed as part of this instruction
+    std::vector<std::shared_ptr<CinnamonMemoryInstruction>> merged;
 
 public:
     CinnamonMemoryInstruction() = delete;
@@ -71,6 +91,113 @@ public:
         }
         phyReg->decReference();
         // phyReg->addToFreeListIfFree();
+        for (auto &instruction : merged) {
+            instruction->setExecutionComplete();
+        }
+        completed = true;
+    }
+
+    bool isCompleted() const {
+        return completed;
+    }
+
+    void setQueued(uint64_t seq, SST::Cycle_t cycle) {
+        sequence = seq;
+        queuedCycle = cycle;
+    }
+
+    // Position in the order the memory unit received its instructions in
+    uint64_t getSequence() const {
+        return sequence;
+    }
+
+    SST::Cycle_t getQueuedCycle() const {
+        return queuedCycle;
+    }
+
+    void setDeferred() {
+        deferred = true;
+    }
+
+    bool wasDeferred() const {
+        return deferred;
+    }
+
+    std::uint16_t limbGroupSize() const override {
+        return 1 + merged.size();
+    }
+
+    void merge(const std::shared_ptr<CinnamonMemoryInstruction> &instruction) {
+        assert(instruction->getOpCode() == opCode);
+        size += instruction->getSize();
+        merged.push_back(instruction);
+    }
+
+    bool isMerged() const {
+        return !merged.empty();
+    }
+
+    // Calls f with the address of every limb this instruction transfers
+    template <typename F>
+    void forEachLimb(F f) const {
+        f(addr);
+        for (auto &instruction : merged) {
+            f(instruction->getAddr());
+        }
+    }
+
+    // True if this instruction or one merged into it transfers the limb at addr
+    bool covers(Interfaces::StandardMem::Addr limb) const {
+        if (addr == limb) {
+            return true;
+        }
+        for (auto &instruction : merged) {
+            if (instruction->getAddr() == limb) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Register of the member that transfers the limb at addr
+    std::shared_ptr<PhysicalRegister> getPhyReg(Interfaces::StandardMem::Addr limb) {
+        for (auto &instruction : merged) {
+            if (instruction->getAddr() == limb) {
+                return instruction->getPhyReg();
+            }
+        }
+        return phyReg;
+    }
+
+    // Removes the merged instruction that transfers the limb at addr from the group
+    std::shared_ptr<CinnamonMemoryInstruction> unmerge(Interfaces::StandardMem::Addr limb) {
+        for (auto it = merged.begin(); it != merged.end(); it++) {
+            if ((*it)->getAddr() == limb) {
+                auto instruction = *it;
+                merged.erase(it);
+                size -= instruction->getSize();
+                return instruction;
+            }
+        }
+        return nullptr;
+    }
+
+    // Makes the first merged instruction the leader of the rest of the group, so this instruction
+    // can be removed from it. The new leader takes over the queue position
+    std::shared_ptr<CinnamonMemoryInstruction> promote() {
+        assert(!merged.empty());
+        auto leader = merged.front();
+        size -= leader->getSize();
+        for (size_t i = 1; i < merged.size(); i++) {
+            size -= merged.at(i)->getSize();
+            leader->merge(merged.at(i));
+        }
+        merged.clear();
+        leader->setQueued(sequence, queuedCycle);
+        if (deferred) {
+            leader->setDeferred();
+        }
+        return leader;
     }
 
     std::shared_ptr<PhysicalRegister> getPhyReg() {
@@ -88,6 +215,9 @@ public:
     std::string getString() const override {
         std::stringstream s;
         s << getOpCodeString(opCode) << " " << phyReg->getString() << " : 0x" << std::hex << addr << std::dec;
+        if (!merged.empty()) {
+            s << " +" << merged.size() << " limbs";
+        }
         return s.str();
     }
 
@@ -101,6 +231,67 @@ public:
     }
 };
 
+// Independent instructions with the same opcode on different limbs issued as one instruction.
+// The functional unit is occupied for all the limbs of the group
+class CinnamonMacroInstruction : public CinnamonInstruction {
+
+    std::vector<std::shared_ptr<CinnamonInstruction>> members;
+
+public:
+    CinnamonMacroInstruction(const std::vector<std::shared_ptr<CinnamonInstruction>> &members) : CinnamonInstruction(members.at(0)->getOpCode()), members(members) {
+        for (auto &member : members) {
+            if (member->getOpCode() != opCode) {
+                throw std::invalid_argument("Macro Instruction members must have the same OpCode");
+            }
+        }
+    }
+
+    bool allOperandsReady() const override {
+        for (auto &member : members) {
+            if (!member->allOperandsReady()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void setExecutionComplete() override {
+        for (auto &member : members) {
+            member->setExecutionComplete();
+        }
+    }
+
+    std::uint16_t limbGroupSize() const override {
+        return members.size();
+    }
+
+    std::optional<StreamedStart> streamedStart(SST::Cycle_t readCycles) const override {
+        // Members are processed one after the other, each reading its operands for an equal share of readCycles
+        const SST::Cycle_t memberCycles = readCycles / members.size();
+        StreamedStart streamed;
+        for (size_t i = 0; i < members.size(); i++) {
+            auto member = members[i]->streamedStart(memberCycles);
+            if (!member) {
+                return std::nullopt;
+            }
+            const SST::Cycle_t offset = i * memberCycles;
+            streamed.start = std::max(streamed.start, member->start > offset ? member->start - offset : 0);
+            streamed.complete = std::max(streamed.complete, member->complete);
+        }
+        return streamed;
+    }
+
+    std::string getString() const override {
+        std::stringstream s;
+        s << "{ " << members.at(0)->getString();
+        for (size_t i = 1; i < members.size(); i++) {
+            s << "; " << members.at(i)->getString();
+        }
+        s << " }";
+        return s.str();
+    }
+};
+
 class CinnamonBinOpInstruction : public CinnamonInstruction {
 
     std::shared_ptr<PhysicalRegister> dest;
@@ -123,6 +314,19 @@ public:
         return src1->getValueReady() && src2->getValueReady();
     }
 
+    std::optional<StreamedStart> streamedStart(SST::Cycle_t readCycles) const override {
+        StreamedStart streamed;
+        for (auto &src : {src1, src2}) {
+            auto start = src->consumerStart(readCycles);
+            if (!start) {
+                return std::nullopt;
+            }
+            streamed.start = std::max<SST::Cycle_t>(streamed.start, *start);
+            streamed.complete = std::max<SST::Cycle_t>(streamed.complete, src->streamEnd());
+        }
+        return streamed;
+    }
+
     void setExecutionComplete() override {
         src1->decReference();
         src2->decReference();
@@ -488,6 +692,18 @@ public:
         return src1->getValueReady();
     }
 
+    std::optional<StreamedStart> streamedStart(SST::Cycle_t readCycles) const override {
+        // Only negation works element by element
+        if (opCode != OpCode::Neg) {
+            return std::nullopt;
+        }
+        auto start = src1->consumerStart(readCycles);
+        if (!start) {
+            return std::nullopt;
+        }
+        return StreamedStart{*start, src1->streamEnd()};
+    }
+
     void setExecutionComplete() override {
         src1->decReference();
         dest->setValueReady(true);
@@ -932,20 +1148,24 @@ class CinnamonDisInstruction : public CinnamonInstruction {
     std::shared_ptr<PhysicalRegister> src1;
     std::uint64_t syncID_;
     std::uint64_t syncSize_;
+    std::uint64_t bytes_; // Size of the value sent or received
     std::optional<LimbID_t> limb;
 
 public:
-    CinnamonDisInstruction(const OpCode opCode, const std::shared_ptr<PhysicalRegister> &dest, const std::shared_ptr<PhysicalRegister> &src1, const uint64_t syncID, const uint64_t syncSize) : dest(dest), src1(src1), syncID_(syncID), syncSize_(syncSize), CinnamonInstruction(opCode) {
+    CinnamonDisInstruction(const OpCode opCode, const std::shared_ptr<PhysicalRegister> &dest, const std::shared_ptr<PhysicalRegister> &src1, const uint64_t syncID, const uint64_t syncSize, const uint64_t bytes) : CinnamonInstruction(opCode), dest(dest), src1(src1), syncID_(syncID), syncSize_(syncSize), bytes_(bytes) {
         switch (opCode) {
         case OpCode::Rcv:
         case OpCode::Dis:
+        case OpCode::Agt:
+        case OpCode::Rsc:
+        case OpCode::Ata:
             break;
         default:
             throw std::invalid_argument("Invalid Dis Instruction with OpCode : " + getOpCodeString(opCode));
         }
     };
 
-    CinnamonDisInstruction(const OpCode opCode, const std::shared_ptr<PhysicalRegister> &dest, const std::shared_ptr<PhysicalRegister> &src1, const uint64_t syncID, const uint64_t syncSize, const LimbID_t limb) : dest(dest), src1(src1), syncID_(syncID), syncSize_(syncSize), limb(limb), CinnamonInstruction(opCode) {
+    CinnamonDisInstruction(const OpCode opCode, const std::shared_ptr<PhysicalRegister> &dest, const std::shared_ptr<PhysicalRegister> &src1, const uint64_t syncID, const uint64_t syncSize, const uint64_t bytes, const LimbID_t limb) : CinnamonInstruction(opCode), dest(dest), src1(src1), syncID_(syncID), syncSize_(syncSize), bytes_(bytes), limb(limb) {
         switch (opCode) {
         case OpCode::Joi:
             break;
@@ -955,7 +1175,7 @@ public:
     };
 
     bool allOperandsReady() const override {
-        if (opCode == OpCode::Dis) {
+        if (opCode == OpCode::Dis || opCode == OpCode::Agt || opCode == OpCode::Rsc || opCode == OpCode::Ata) {
             return src1->getValueReady();
         } else if (opCode == OpCode::Joi) {
             if (src1 != nullptr) {
@@ -978,10 +1198,17 @@ public:
         }
     }
 
+    // The result is written into dest in chunks between cycles start and end
+    void streamResult(SST::Cycle_t start, SST::Cycle_t end, uint64_t chunks) {
+        if (dest != nullptr) {
+            dest->setStreaming(start, end, chunks);
+        }
+    }
+
     std::string getString() const override {
         std::stringstream s;
         s << getOpCodeString(opCode);
-        s << " @ " << syncID_ << ":" << syncSize_ << " ";
+        s << " @ " << syncID_ << ":" << syncSize_ << ":" << bytes_ << " ";
         if (dest) {
             s << dest->getString();
         }
@@ -1003,6 +1230,10 @@ public:
         return syncSize_;
     }
 
+    auto bytes() const {
+        return bytes_;
+    }
+
     bool hasSource() const {
         return src1 != nullptr;
     }
@@ -0,0 +1,103 @@
+// Copyright (c) Siddharth Jayashankar. All rights reserved.
+#include "memoizer.h"
+
+#include <cassert>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+namespace SST {
+namespace Cinnamon {
+
+CinnamonActivitySnapshot CinnamonActivitySnapshot::operator-(const CinnamonActivitySnapshot &rhs) const {
+    assert(fuBusyCycles.size() == rhs.fuBusyCycles.size());
+    CinnamonActivitySnapshot delta;
+    delta.cycle = cycle - rhs.cycle;
+    for (size_t i = 0; i < fuBusyCycles.size(); i++) {
+        delta.fuBusyCycles.push_back(fuBusyCycles[i] - rhs.fuBusyCycles[i]);
+        delta.fuIssueCycles.push_back(fuIssueCycles[i] - rhs.fuIssueCycles[i]);
+    }
+    delta.memoryLoads = memoryLoads - rhs.memoryLoads;
+    delta.memoryStores = memoryStores - rhs.memoryStores;
+    delta.memoryBusyCycles = memoryBusyCycles - rhs.memoryBusyCycles;
+    delta.memoryLatency = memoryLatency - rhs.memoryLatency;
+    return delta;
+}
+
+CinnamonTimingMemoizer::CinnamonTimingMemoizer(size_t blockSize, double verifyRate, uint64_t seed) : blockSize_(blockSize), verifyRate(verifyRate), rng(seed), uniform(0.0, 1.0) {
+    if (blockSize_ == 0) {
+        throw std::invalid_argument("Memoization block size must be non-zero");
+    }
+}
+
+CinnamonTimingMemoizer::Entry *CinnamonTimingMemoizer::lookup(uint64_t key) {
+    auto it = cache.find(key);
+    if (it == cache.end()) {
+        stats_.misses++;
+        return nullptr;
+    }
+    // Hits that are simulated to verify the recorded timing are hits too
+    stats_.hits++;
+    it->second.hits++;
+    return &(it->second);
+}
+
+void CinnamonTimingMemoizer::record(uint64_t key, const CinnamonActivitySnapshot &delta) {
+    cache[key].delta = delta;
+}
+
+void CinnamonTimingMemoizer::recordUncacheable() {
+    stats_.uncacheable++;
+}
+
+void CinnamonTimingMemoizer::recordReplay(Entry &entry) {
+    stats_.cyclesReplayed += entry.delta.cycle;
+}
+
+bool CinnamonTimingMemoizer::sampleVerification() {
+    if (verifyRate <= 0.0) {
+        return false;
+    }
+    return uniform(rng) < verifyRate;
+}
+
+void CinnamonTimingMemoizer::verify(uint64_t key, const CinnamonActivitySnapshot &measured) {
+    auto &entry = cache.at(key);
+    stats_.verified++;
+    if (entry.delta.cycle == measured.cycle) {
+        stats_.verifiedExact++;
+    }
+    double error = 0.0;
+    if (measured.cycle != 0) {
+        error = std::abs(static_cast<double>(entry.delta.cycle) - static_cast<double>(measured.cycle)) / measured.cycle;
+    }
+    stats_.totalError += error;
+    if (error > stats_.maxError) {
+        stats_.maxError = error;
+    }
+}
+
+std::string CinnamonTimingMemoizer::printStats() const {
+    std::stringstream s;
+    s << "Timing Memoization\n";
+    s << "\tBlock Size: " << blockSize_ << "\n";
+    s << "\tCached Blocks: " << cache.size() << "\n";
+    s << "\tHits: " << stats_.hits << "\n";
+    s << "\tMisses: " << stats_.misses << "\n";
+    s << "\tUncacheable Blocks: " << stats_.uncacheable << "\n";
+    uint64_t lookups = stats_.hits + stats_.misses;
+    double hitRate = lookups ? ((100.0) * stats_.hits) / lookups : 0.0;
+    s << "\tHit Rate %: " << hitRate << "\n";
+    s << "\tCycles Replayed: " << stats_.cyclesReplayed << "\n";
+    if (verifyRate > 0.0) {
+        s << "\tVerified Hits: " << stats_.verified << "\n";
+        s << "\tExactly Matching Hits: " << stats_.verifiedExact << "\n";
+        double avgError = stats_.verified ? (100.0 * stats_.totalError) / stats_.verified : 0.0;
+        s << "\tAverage Verification Error %: " << avgError << "\n";
+        s << "\tMax Verification Error %: " << 100.0 * stats_.maxError << "\n";
+    }
+    return s.str();
+}
+
+} // Namespace Cinnamon
+} // Namespace SST
@@ -0,0 +1,80 @@
+// Copyright (c) Siddharth Jayashankar. All rights reserved.
+#ifndef _H_SST_CINNAMON_MEMOIZER
+#define _H_SST_CINNAMON_MEMOIZER
+
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "sst/core/sst_types.h"
+
+namespace SST {
+namespace Cinnamon {
+
+// Activity counters of a chip at one cycle.
+// The difference of two snapshots is the time and activity of everything simulated in between
+struct CinnamonActivitySnapshot {
+    SST::Cycle_t cycle = 0;
+    std::vector<SST::Cycle_t> fuBusyCycles;
+    std::vector<SST::Cycle_t> fuIssueCycles;
+    uint64_t memoryLoads = 0;
+    uint64_t memoryStores = 0;
+    SST::Cycle_t memoryBusyCycles = 0;
+    SST::Cycle_t memoryLatency = 0;
+
+    CinnamonActivitySnapshot operator-(const CinnamonActivitySnapshot &rhs) const;
+};
+
+// Block level timing cache.
+// A block is keyed by the structure of its instructions together with a summary of the machine state
+// when the block is entered. The first simulation of a block records its timing; later occurrences
+// advance time and statistics by the recorded delta instead of being simulated
+class CinnamonTimingMemoizer {
+public:
+    struct Entry {
+        CinnamonActivitySnapshot delta;
+        uint64_t hits = 0;
+    };
+
+    CinnamonTimingMemoizer(size_t blockSize, double verifyRate, uint64_t seed);
+
+    size_t blockSize() const {
+        return blockSize_;
+    }
+
+    // Returns the recorded timing for key, nullptr on a miss
+    Entry *lookup(uint64_t key);
+    void record(uint64_t key, const CinnamonActivitySnapshot &delta);
+    void recordUncacheable();
+    void recordReplay(Entry &entry);
+
+    // Strict mode: returns true if a hit should be simulated in detail to check the recorded timing
+    bool sampleVerification();
+    void verify(uint64_t key, const CinnamonActivitySnapshot &measured);
+
+    std::string printStats() const;
+
+private:
+    size_t blockSize_;
+    double verifyRate;
+    std::mt19937_64 rng;
+    std::uniform_real_distribution<double> uniform;
+    std::unordered_map<uint64_t, Entry> cache;
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t uncacheable = 0;
+        uint64_t verified = 0;
+        uint64_t verifiedExact = 0;
+        double totalError = 0.0;
+        double maxError = 0.0;
+        SST::Cycle_t cyclesReplayed = 0;
+    } stats_;
+};
+
+} // Namespace Cinnamon
+} // Namespace SST
+
+#endif
@@ -4,12 +4,20 @@
 #include "chip.h"
 #include "sst/core/interfaces/stdMem.h"
 
+#include <algorithm>
+
 namespace SST {
 namespace Cinnamon {
 
 // CinnamonAccelerator::CinnamonMemoryUnit::CinnamonMemoryUnit(Interfaces::StandardMem * memory) : memory(memory), busyWith(nullptr), cyclesToCompletion(0) {};
-CinnamonMemoryUnit::CinnamonMemoryUnit(CinnamonChip *pe, CinnamonAccelerator *accelerator, const uint32_t outputLevel, Interfaces::StandardMem *memory, size_t requestWidth) : pe(pe), accelerator(accelerator), memory(memory), requestWidth(requestWidth) {
+CinnamonMemoryUnit::CinnamonMemoryUnit(CinnamonChip *pe, CinnamonAccelerator *accelerator, const uint32_t outputLevel, Interfaces::StandardMem *memory, const Config &config) : pe(pe), accelerator(accelerator), memory(memory), requestWidth(config.requestWidth), config(config), memRequest(config.numMSHRs), mshrAllocator(config.numMSHRs) {
     output = std::make_shared<SST::Output>(SST::Output("CinnamonMemoryUnit[@p:@l]: ", outputLevel, 0, SST::Output::STDOUT));
+    if (config.numMSHRs == 0) {
+        throw std::invalid_argument("Memory unit needs at least one MSHR");
+    }
+    if (config.requestWidth == 0) {
+        throw std::invalid_argument("Memory request width must be non-zero");
+    }
     // Interfaces::StandardMem * memory = accelerator->loadUserSubComponent<Interfaces::StandardMem>("memory", ComponentInfo::SHARE_NONE, time, new Interfaces::StandardMem::Handler<CinnamonMemoryUnit>(this, &CinnamonMemoryUnit::handleResponse) );
     // if ( !memory ) {
     //     output->fatal(CALL_INFO, -1, "Unable to load memoryInterface subcomponent\n");
@@ -25,122 +33,354 @@ void CinnamonMemoryUnit::setup() {
     auto lineSize = memory->getLineSize();
 }
 
+CinnamonMemoryUnit::Config::Arbitration CinnamonMemoryUnit::parseArbitration(const std::string &arbitration) {
+    using Arbitration = Config::Arbitration;
+    if (arbitration == "loadsFirst") {
+        return Arbitration::LoadsFirst;
+    }
+    if (arbitration == "age") {
+        return Arbitration::Age;
+    }
+    if (arbitration == "deadline") {
+        return Arbitration::Deadline;
+    }
+    if (arbitration == "deferSpills") {
+        return Arbitration::DeferSpills;
+    }
+    throw std::invalid_argument("Unknown memory arbitration " + arbitration + ". Expected loadsFirst, age, deadline or deferSpills");
+}
+
 void CinnamonMemoryUnit::addToLoadQueue(std::shared_ptr<CinnamonMemoryInstruction> instruction) {
+    instruction->setQueued(nextSequence++, lastCycle);
     loadQueue.emplace_back(instruction);
+    addToIndex(loadIndex, std::prev(loadQueue.end()));
 }
 
 void CinnamonMemoryUnit::addToStoreQueue(std::shared_ptr<CinnamonMemoryInstruction> instruction) {
+    instruction->setQueued(nextSequence++, lastCycle);
     storeQueue.emplace_back(instruction);
+    addToIndex(storeIndex, std::prev(storeQueue.end()));
+    // Loads dispatched after the store must not forward from a load that read the old value
+    instruction->forEachLimb([&](Interfaces::StandardMem::Addr limb) { claimedLoads.erase(limb); });
+}
+
+void CinnamonMemoryUnit::addToScalarQueue(std::shared_ptr<CinnamonMemoryInstruction> instruction) {
+    instruction->setQueued(nextSequence++, lastCycle);
+    scalarQueue.emplace_back(instruction);
+    addToIndex(scalarIndex, std::prev(scalarQueue.end()));
+}
+
+void CinnamonMemoryUnit::markBusy(Interfaces::StandardMem::Addr addr) {
+    busyLimbs[addr]++;
+}
+
+void CinnamonMemoryUnit::markIdle(Interfaces::StandardMem::Addr addr) {
+    auto it = busyLimbs.find(addr);
+    assert(it != busyLimbs.end());
+    if (--it->second == 0) {
+        busyLimbs.erase(it);
+    }
+}
+
+CinnamonMemoryUnit::AliasIndex &CinnamonMemoryUnit::indexOf(const MemoryQueue &queue) {
+    if (&queue == &loadQueue) {
+        return loadIndex;
+    }
+    if (&queue == &scalarQueue) {
+        return scalarIndex;
+    }
+    return storeIndex;
+}
+
+void CinnamonMemoryUnit::addToIndex(AliasIndex &index, MemoryQueue::iterator entry) {
+    (*entry)->forEachLimb([&](Interfaces::StandardMem::Addr limb) {
+        index.emplace(limb, entry);
+        markBusy(limb);
+    });
+}
+
+void CinnamonMemoryUnit::removeFromIndex(AliasIndex &index, MemoryQueue::iterator entry) {
+    (*entry)->forEachLimb([&](Interfaces::StandardMem::Addr limb) {
+        auto range = index.equal_range(limb);
+        for (auto it = range.first; it != range.second; it++) {
+            if (it->second == entry) {
+                index.erase(it);
+                return;
+            }
+        }
+        assert(0 && "Queued memory instruction missing from alias index");
+    });
 }
 
 std::shared_ptr<PhysicalRegister> CinnamonMemoryUnit::findStoreAlias(Interfaces::StandardMem::Addr addr, bool quashAliasingStore) {
-    std::shared_ptr<PhysicalRegister> aliasPhyReg = nullptr;
     using OpCode = CinnamonInstruction::OpCode;
-    auto it = storeQueue.rbegin();
-    for (; it != storeQueue.rend();) {
-        std::shared_ptr<CinnamonMemoryInstruction> instruction = *it;
-        if (instruction->getAddr() == addr) {
-            aliasPhyReg = instruction->getPhyReg();
-            output->verbose(CALL_INFO, 4, 0, "%s: Found Store Alias for addr %" PRIx64 ": %s.\n",
-                            pe->getName().c_str(), addr, instruction->getString().c_str());
-
-            // Subsequent loads to the same address can quash aliasing spills
-            // Subsequent stores/spills to the same address can quash aliasing spills. These
-            // Instructions must set quashAliasingStore to be true
-            if (quashAliasingStore || instruction->getOpCode() == OpCode::Spill) {
-                instruction->quash();
-                // instruction->setExecutionComplete();
-                it = decltype(it)(storeQueue.erase(std::next(it).base()));
-                output->verbose(CALL_INFO, 4, 0, "%s: Quashing Store Alias for addr %" PRIx64 ": %s.\n",
-                                pe->getName().c_str(), addr, instruction->getString().c_str());
+    auto range = storeIndex.equal_range(addr);
+    if (range.first == range.second) {
+        return nullptr;
+    }
+    // Youngest store to the address
+    auto youngest = std::prev(range.second);
+    std::shared_ptr<CinnamonMemoryInstruction> instruction = *(youngest->second);
+    std::shared_ptr<PhysicalRegister> aliasPhyReg = instruction->getPhyReg(addr);
+    output->verbose(CALL_INFO, 4, 0, "%s: Found Store Alias for addr %" PRIx64 ": %s.\n",
+                    pe->getName().c_str(), addr, instruction->getString().c_str());
+
+    // Subsequent loads to the same address can quash aliasing spills
+    // Subsequent stores/spills to the same address can quash aliasing spills. These
+    // Instructions must set quashAliasingStore to be true
+    // Only the limb at addr is quashed from a coarsened store. The rest of the group stays queued
+    if (quashAliasingStore || instruction->getOpCode() == OpCode::Spill) {
+        if (instruction->getOpCode() == OpCode::Spill) {
+            stats_.spillsQuashed++;
+            if (instruction->wasDeferred()) {
+                stats_.deferredSpillsQuashed++;
             }
-            return aliasPhyReg;
         }
-        it++;
+        auto entry = youngest->second;
+        storeIndex.erase(youngest);
+        markIdle(addr);
+        if (!instruction->isMerged()) {
+            storeQueue.erase(entry);
+        } else if (instruction->getAddr() == addr) {
+            *entry = instruction->promote();
+        } else {
+            instruction = instruction->unmerge(addr);
+        }
+        instruction->quash();
+        // instruction->setExecutionComplete();
+        output->verbose(CALL_INFO, 4, 0, "%s: Quashing Store Alias for addr %" PRIx64 ": %s.\n",
+                        pe->getName().c_str(), addr, instruction->getString().c_str());
     }
-
     return aliasPhyReg;
 }
 
 std::shared_ptr<PhysicalRegister> CinnamonMemoryUnit::findLoadAlias(Interfaces::StandardMem::Addr addr) {
 
-    std::shared_ptr<PhysicalRegister> aliasPhyReg = nullptr;
-    auto it = loadQueue.rbegin();
-    for (; it != loadQueue.rend(); it++) {
-        std::shared_ptr<CinnamonMemoryInstruction> instruction = *it;
-        if (instruction->getAddr() == addr) {
-            aliasPhyReg = instruction->getPhyReg();
-            output->verbose(CALL_INFO, 4, 0, "%s: Found Load Alias for addr %" PRIx64 ": %s.\n",
-                            pe->getName().c_str(), addr, instruction->getString().c_str());
-            return aliasPhyReg;
+    auto range = loadIndex.equal_range(addr);
+    if (range.first == range.second) {
+        range = scalarIndex.equal_range(addr);
+    }
+    std::shared_ptr<CinnamonMemoryInstruction> instruction;
+    if (range.first != range.second) {
+        instruction = *(std::prev(range.second)->second);
+    } else {
+        auto claimed = claimedLoads.find(addr);
+        if (claimed == claimedLoads.end()) {
+            return nullptr;
         }
+        instruction = claimed->second;
     }
-    return aliasPhyReg;
+    output->verbose(CALL_INFO, 4, 0, "%s: Found Load Alias for addr %" PRIx64 ": %s.\n",
+                    pe->getName().c_str(), addr, instruction->getString().c_str());
+    return instruction->getPhyReg(addr);
 }
 
-bool CinnamonMemoryUnit::operateQueue(SST::Cycle_t currentCycle, std::list<std::shared_ptr<CinnamonMemoryInstruction>> &queue, const std::string &queueName) {
-    for (size_t i = 0; i < NumConcurrentRequests; i++) {
-        if (memRequest[i].busyWith == nullptr) {
-            if (queue.empty()) {
-                return false; // nothing to do
-            }
-            auto it = queue.begin();
-            for (; it != queue.end();) {
-                std::shared_ptr<CinnamonMemoryInstruction> instruction = *it;
-                if (instruction->isQuashed() == true) {
-                    assert(0);
-                    // instruction->setExecutionComplete();
-                    // instruction->quash();
-                    // it = storeQueue.erase(it);
-                }
-                if (instruction->allOperandsReady() == true) {
-
-                    output->verbose(CALL_INFO, 4, 0, "%s: %lu Issuing Instruction: %s\n", pe->getName().c_str(), currentCycle, instruction->getString().c_str());
-                    using OpCode = CinnamonInstruction::OpCode;
-                    OpCode op = instruction->getOpCode();
-                    if (op == OpCode::LoadV) {
-                        handleVectorLoad(currentCycle, i, instruction->getAddr(), instruction->getSize());
-                    } else if (op == OpCode::LoadS) {
-                        handleScalarLoad(currentCycle, instruction->getAddr(), instruction->getSize());
-                    } else if (op == OpCode::Store) {
-                        handleVectorStore(currentCycle, i, instruction->getAddr(), instruction->getSize());
-                    } else if (op == OpCode::Spill) {
-                        handleVectorStore(currentCycle, i, instruction->getAddr(), instruction->getSize());
-                    } else {
-                        assert(0);
-                    }
-
-                    memRequest[i].issuedAtCycle = currentCycle;
-                    memRequest[i].busyWith = instruction;
-                    memRequest[i].responseReceived = false;
-                    it = queue.erase(it);
-                    break;
-                } else {
-                    it++;
-                    output->verbose(CALL_INFO, 4, 0, "%s: %lu: %s Waiting for values to be ready. Skipping Ahead: %s\n",
-                                    pe->getName().c_str(), currentCycle, queueName.c_str(), instruction->getString().c_str());
-                }
+bool CinnamonMemoryUnit::canIssue(bool load) const {
+    if (mshrAllocator.full()) {
+        return false;
+    }
+    if (load) {
+        return outstandingLoads < config.maxOutstandingLoads;
+    }
+    return outstandingStores < config.maxOutstandingStores;
+}
+
+bool CinnamonMemoryUnit::registerPressure() const {
+    return pe->freeVectorRegisterCount() < config.freeRegisterWatermark;
+}
+
+bool CinnamonMemoryUnit::hasWaitingConsumer(CinnamonMemoryInstruction &load) {
+    bool waiting = false;
+    load.forEachLimb([&](Interfaces::StandardMem::Addr limb) {
+        waiting = waiting || load.getPhyReg(limb)->numConsumers() > 0;
+    });
+    return waiting;
+}
+
+bool CinnamonMemoryUnit::spillDeferred(const CinnamonMemoryInstruction &instruction, SST::Cycle_t currentCycle) const {
+    using OpCode = CinnamonInstruction::OpCode;
+    if (config.arbitration != Config::Arbitration::DeferSpills || instruction.getOpCode() != OpCode::Spill || draining) {
+        return false;
+    }
+    // A held back spill is quashed if its value is reloaded or overwritten before it issues
+    if (storeQueue.size() >= config.storeQueueWatermark || registerPressure()) {
+        return false;
+    }
+    return currentCycle - instruction.getQueuedCycle() < config.spillDeferLimit;
+}
+
+CinnamonMemoryUnit::MemoryQueue::iterator CinnamonMemoryUnit::nextReady(MemoryQueue &queue, SST::Cycle_t currentCycle) {
+    const char *queueName = (&queue == &loadQueue) ? "loadQueue" : (&queue == &scalarQueue) ? "scalarQueue"
+                                                                                              : "storeQueue";
+    for (auto it = queue.begin(); it != queue.end(); it++) {
+        std::shared_ptr<CinnamonMemoryInstruction> instruction = *it;
+        if (instruction->isQuashed() == true) {
+            assert(0);
+            // instruction->setExecutionComplete();
+            // instruction->quash();
+            // it = storeQueue.erase(it);
+        }
+        if (instruction->allOperandsReady() == false) {
+            output->verbose(CALL_INFO, 4, 0, "%s: %lu: %s Waiting for values to be ready. Skipping Ahead: %s\n",
+                            pe->getName().c_str(), currentCycle, queueName, instruction->getString().c_str());
+            continue;
+        }
+        if (spillDeferred(*instruction, currentCycle)) {
+            if (!instruction->wasDeferred()) {
+                instruction->setDeferred();
+                stats_.spillsDeferred++;
             }
-            if (it == queue.end()) {
-                output->verbose(CALL_INFO, 4, 0, "%s: %lu %s No Instrutctions Ready to be Issued:\n",
-                                pe->getName().c_str(), currentCycle, queueName.c_str());
-                return false;
+            continue;
+        }
+        return it;
+    }
+    output->verbose(CALL_INFO, 4, 0, "%s: %lu %s No Instrutctions Ready to be Issued:\n",
+                    pe->getName().c_str(), currentCycle, queueName);
+    return queue.end();
+}
+
+void CinnamonMemoryUnit::coalesceScalars(const std::shared_ptr<CinnamonMemoryInstruction> &leader) {
+    while (true) {
+        auto next = scalarIndex.find(leader->getAddr() + leader->getSize());
+        if (next == scalarIndex.end()) {
+            return;
+        }
+        auto follower = *(next->second);
+        if (leader->getSize() + follower->getSize() > config.scalarBurstSize) {
+            return;
+        }
+        scalarQueue.erase(next->second);
+        scalarIndex.erase(next);
+        leader->merge(follower);
+    }
+}
+
+void CinnamonMemoryUnit::issue(SST::Cycle_t currentCycle, MemoryQueue &queue, MemoryQueue::iterator it) {
+    const bool load = (&queue != &storeQueue);
+    std::shared_ptr<CinnamonMemoryInstruction> instruction = *it;
+    using OpCode = CinnamonInstruction::OpCode;
+    OpCode op = instruction->getOpCode();
+    // Unindexed before coalescing, since the merged scalar loads leave the index on their own
+    removeFromIndex(indexOf(queue), it);
+    if (op == OpCode::LoadS) {
+        coalesceScalars(instruction);
+    }
+    output->verbose(CALL_INFO, 4, 0, "%s: %lu Issuing Instruction: %s\n", pe->getName().c_str(), currentCycle, instruction->getString().c_str());
+    auto i = mshrAllocator.allocate();
+    if (op == OpCode::LoadV) {
+        handleVectorLoad(currentCycle, i, instruction->getAddr(), instruction->getSize());
+    } else if (op == OpCode::LoadS) {
+        handleScalarLoad(currentCycle, i, instruction->getAddr(), instruction->getSize());
+    } else if (op == OpCode::Store) {
+        handleVectorStore(currentCycle, i, instruction->getAddr(), instruction->getSize());
+    } else if (op == OpCode::Spill) {
+        handleVectorStore(currentCycle, i, instruction->getAddr(), instruction->getSize());
+    } else {
+        assert(0);
+    }
+    // Coarsened transfers are counted once per limb
+    if (op == OpCode::LoadV) {
+        stats_.loadsIssued += instruction->limbGroupSize() - 1;
+    } else if (op == OpCode::LoadS) {
+        stats_.scalarLoadsIssued += instruction->limbGroupSize() - 1;
+    } else {
+        stats_.storesIssued += instruction->limbGroupSize() - 1;
+    }
+    if (instruction->wasDeferred()) {
+        stats_.spillDeferCycles += currentCycle - instruction->getQueuedCycle();
+    }
+
+    memRequest[i].issuedAtCycle = currentCycle;
+    memRequest[i].busyWith = instruction;
+    memRequest[i].addr = instruction->getAddr();
+    memRequest[i].responseReceived = false;
+    activeMSHRs.push_back(i);
+    if (load) {
+        outstandingLoads++;
+    } else {
+        outstandingStores++;
+    }
+    stats_.maxMSHRsInUse = std::max(stats_.maxMSHRsInUse, mshrAllocator.allocated());
+    queue.erase(it);
+}
+
+bool CinnamonMemoryUnit::operateQueue(SST::Cycle_t currentCycle, std::list<std::shared_ptr<CinnamonMemoryInstruction>> &queue) {
+    const bool load = (&queue != &storeQueue);
+    while (true) {
+        if (queue.empty()) {
+            return false; // nothing to do
+        }
+        if (!canIssue(load)) {
+            return true;
+        }
+        auto it = nextReady(queue, currentCycle);
+        if (it == queue.end()) {
+            return false;
+        }
+        issue(currentCycle, queue, it);
+    }
+}
+
+void CinnamonMemoryUnit::arbitrate(SST::Cycle_t currentCycle) {
+    using Arbitration = Config::Arbitration;
+    while (true) {
+        // Scalar loads are small and their consumers cannot start without them
+        auto scalar = canIssue(true) ? nextReady(scalarQueue, currentCycle) : scalarQueue.end();
+        if (scalar != scalarQueue.end()) {
+            issue(currentCycle, scalarQueue, scalar);
+            continue;
+        }
+        auto load = canIssue(true) ? nextReady(loadQueue, currentCycle) : loadQueue.end();
+        auto store = canIssue(false) ? nextReady(storeQueue, currentCycle) : storeQueue.end();
+        bool issueLoad;
+        if (load == loadQueue.end() && store == storeQueue.end()) {
+            break;
+        } else if (store == storeQueue.end()) {
+            issueLoad = true;
+        } else if (load == loadQueue.end()) {
+            issueLoad = false;
+        } else {
+            switch (config.arbitration) {
+            case Arbitration::Age:
+                issueLoad = (*load)->getSequence() < (*store)->getSequence();
+                break;
+            case Arbitration::Deadline:
+                issueLoad = hasWaitingConsumer(**load) || !registerPressure();
+                break;
+            default:
+                issueLoad = true;
             }
         }
+        if (issueLoad) {
+            issue(currentCycle, loadQueue, load);
+        } else {
+            issue(currentCycle, storeQueue, store);
+        }
     }
-    return true;
 }
 
 void CinnamonMemoryUnit::executeCycleBegin(SST::Cycle_t currentCycle) {
     bool busy = false;
-    operateQueue(currentCycle, loadQueue, "loadQueue");
-    operateQueue(currentCycle, storeQueue, "storeQueue");
-    stats_.totalCycles++;
-    for (size_t i = 0; i < NumConcurrentRequests; i++) {
-        if (memRequest[i].busyWith != nullptr) {
-            busy = true;
-        }
+    lastCycle = currentCycle;
+    if (config.arbitration == Config::Arbitration::LoadsFirst) {
+        operateQueue(currentCycle, scalarQueue);
+        operateQueue(currentCycle, loadQueue);
+        operateQueue(currentCycle, storeQueue);
+    } else {
+        arbitrate(currentCycle);
+    }
+    if (mshrAllocator.full() && (!scalarQueue.empty() || !loadQueue.empty() || !storeQueue.empty())) {
+        stats_.mshrFullCycles++;
     }
+    issuePrefetches(currentCycle);
+    stats_.totalCycles++;
+    stats_.loadQueueOccupancy += loadQueue.size();
+    stats_.storeQueueOccupancy += storeQueue.size();
+    stats_.maxLoadQueueOccupancy = std::max(stats_.maxLoadQueueOccupancy, loadQueue.size());
+    stats_.maxStoreQueueOccupancy = std::max(stats_.maxStoreQueueOccupancy, storeQueue.size());
+    stats_.maxScalarQueueOccupancy = std::max(stats_.maxScalarQueueOccupancy, scalarQueue.size());
+    stats_.mshrOccupancy += activeMSHRs.size();
+    busy = !activeMSHRs.empty();
     if (busy) {
         stats_.busyCycles++;
         stats_.busyCyclesWindow++;
@@ -153,15 +393,61 @@ void CinnamonMemoryUnit::executeCycleBegin(SST::Cycle_t currentCycle) {
     }
 }
 
+void CinnamonMemoryUnit::completeRequest(uint32_t i, SST::Cycle_t currentCycle) {
+    using OpCode = CinnamonInstruction::OpCode;
+    if (memRequest[i].busyWith == nullptr) {
+        // Prefetch that no load has claimed yet. It may have been invalidated while in flight
+        auto it = prefetchBuffer.find(memRequest[i].addr);
+        if (it != prefetchBuffer.end() && it->second.state == PrefetchEntry::State::InFlight && it->second.mshr == i) {
+            it->second.state = PrefetchEntry::State::Ready;
+        }
+        output->verbose(CALL_INFO, 3, 0, "%s: [Time: %" PRIu64 "] Completed Prefetch for address 0x%" PRIx64 "\n",
+                        pe->getName().c_str(), currentCycle, memRequest[i].addr);
+        outstandingLoads--;
+        markIdle(memRequest[i].addr);
+    } else {
+        memRequest[i].busyWith->setExecutionComplete();
+        memRequest[i].busyWith->forEachLimb([&](Interfaces::StandardMem::Addr limb) { markIdle(limb); });
+        auto claimed = claimedLoads.find(memRequest[i].addr);
+        if (claimed != claimedLoads.end() && claimed->second == memRequest[i].busyWith) {
+            claimedLoads.erase(claimed);
+        }
+        output->verbose(CALL_INFO, 3, 0, "%s: [Time: %" PRIu64 "] Completed Instruction: %s\n",
+                        pe->getName().c_str(), currentCycle, memRequest[i].busyWith->getString().c_str());
+        auto op = memRequest[i].busyWith->getOpCode();
+        if (op == OpCode::LoadV || op == OpCode::LoadS) {
+            outstandingLoads--;
+        } else {
+            outstandingStores--;
+        }
+    }
+    memRequest[i].busyWith = nullptr;
+    memRequest[i].responseReceived = false;
+    mshrAllocator.deallocate(i);
+}
+
 void CinnamonMemoryUnit::executeCycleEnd(SST::Cycle_t currentCycle) {
 
-    for (size_t i = 0; i < NumConcurrentRequests; i++) {
-        if (memRequest[i].responseReceived) {
-            memRequest[i].busyWith->setExecutionComplete();
-            output->verbose(CALL_INFO, 3, 0, "%s: [Time: %" PRIu64 "] Completed Instruction: %s\n",
-                            pe->getName().c_str(), currentCycle, memRequest[i].busyWith->getString().c_str());
-            memRequest[i].busyWith = nullptr;
-            memRequest[i].responseReceived = false;
+    for (auto read = localReads.begin(); read != localReads.end();) {
+        if (read->readyCycle <= currentCycle && (read->waitFor == nullptr || read->waitFor->isCompleted())) {
+            read->instruction->setExecutionComplete();
+            output->verbose(CALL_INFO, 3, 0, "%s: [Time: %" PRIu64 "] Completed Local Read: %s\n",
+                            pe->getName().c_str(), currentCycle, read->instruction->getString().c_str());
+            read = localReads.erase(read);
+        } else {
+            read++;
+        }
+    }
+
+    auto it = activeMSHRs.begin();
+    while (it != activeMSHRs.end()) {
+        if (memRequest[*it].responseReceived) {
+            completeRequest(*it, currentCycle);
+            it = activeMSHRs.erase(it);
+        } else if (config.inOrderCompletion) {
+            break; // Younger transfers wait for the oldest one
+        } else {
+            it++;
         }
     }
 }
@@ -174,8 +460,8 @@ void CinnamonMemoryUnit::handleResponse(SST::Interfaces::StandardMem::Request *r
     if (it == outstandingRequestID.end()) {
         output->fatal(CALL_INFO, -1, "Event (%" PRIx64 ") not found!\n", response->getID());
     } else {
-        memReq = it->second;
-        memReq->bytesProcessed += requestWidth;
+        memReq = it->second.mshr;
+        memReq->bytesProcessed += it->second.size;
         outstandingRequestID.erase(it);
         SimTime_t et = accelerator->getCurrentSimTime() - memReq->issuedAtCycle;
         output->verbose(CALL_INFO, 5, 0, "%s: Received Response: %lu [Time: %" PRIu64 "] [%zu outstanding requests]\n",
@@ -193,12 +479,26 @@ void CinnamonMemoryUnit::handleResponse(SST::Interfaces::StandardMem::Request *r
     }
 }
 
+size_t CinnamonMemoryUnit::transferChunkSize(std::size_t size) const {
+    if (!config.bulkTransfers) {
+        return requestWidth;
+    }
+    if (config.bulkTransferSize == 0 || config.bulkTransferSize > size) {
+        return size;
+    }
+    return config.bulkTransferSize;
+}
+
 void CinnamonMemoryUnit::handleVectorLoad(SST::Cycle_t currentCycle, size_t memRequestIndex, Interfaces::StandardMem::Addr addr, std::size_t size) {
 
     auto memRequestPtr = &(memRequest[memRequestIndex]);
-    for (size_t i = 0; i < size; i += requestWidth) {
-        auto request = std::make_unique<Interfaces::StandardMem::Read>(addr + i, requestWidth);
-        outstandingRequestID[request->getID()] = memRequestPtr;
+    const size_t chunk = transferChunkSize(size);
+    for (size_t i = 0; i < size; i += chunk) {
+        // Bulk transfers trim the last request. Per request mode always sends requestWidth bytes
+        size_t requestSize = config.bulkTransfers ? std::min(chunk, size - i) : chunk;
+        auto request = std::make_unique<Interfaces::StandardMem::Read>(addr + i, requestSize);
+        outstandingRequestID[request->getID()] = OutstandingRequest{memRequestPtr, requestSize};
+        stats_.requestsSent++;
         output->verbose(CALL_INFO, 5, 0, "%s: %lu Issued Read for address 0x%" PRIx64 "\n",
                         pe->getName().c_str(), currentCycle, addr + i);
         memory->send(request.release());
@@ -211,10 +511,13 @@ void CinnamonMemoryUnit::handleVectorLoad(SST::Cycle_t currentCycle, size_t memR
 void CinnamonMemoryUnit::handleVectorStore(SST::Cycle_t currentCycle, size_t memRequestIndex, Interfaces::StandardMem::Addr addr, std::size_t size) {
 
     auto memRequestPtr = &(memRequest[memRequestIndex]);
-    for (size_t i = 0; i < size; i += requestWidth) {
+    const size_t chunk = transferChunkSize(size);
+    for (size_t i = 0; i < size; i += chunk) {
+        size_t requestSize = config.bulkTransfers ? std::min(chunk, size - i) : chunk;
         std::vector<uint8_t> data;
-        auto request = std::make_unique<Interfaces::StandardMem::Write>(addr + i, requestWidth, data);
-        outstandingRequestID[request->getID()] = memRequestPtr;
+        auto request = std::make_unique<Interfaces::StandardMem::Write>(addr + i, requestSize, data);
+        outstandingRequestID[request->getID()] = OutstandingRequest{memRequestPtr, requestSize};
+        stats_.requestsSent++;
         output->verbose(CALL_INFO, 5, 0, "%s: %lu Issued Write for address 0x%" PRIx64 "\n",
                         pe->getName().c_str(), currentCycle, addr + i);
         memory->send(request.release());
@@ -224,27 +527,133 @@ void CinnamonMemoryUnit::handleVectorStore(SST::Cycle_t currentCycle, size_t mem
     stats_.storesIssued++;
 }
 
-void CinnamonMemoryUnit::handleScalarLoad(SST::Cycle_t currentCycle, Interfaces::StandardMem::Addr addr, std::size_t size) {
-    assert(0);
-    // size_t scalarSize = (1024* 28) / 8; // 3.5 KB
-    // auto request = std::make_unique<Interfaces::StandardMem::Read>(addr, size);
-    // outstandingRequestID.insert(request->getID());
-    // output->verbose(CALL_INFO, 4, 0, "%s: %lu Issued Read for address 0x%" PRIx64 "\n",
-    // 					pe->getName().c_str(), currentCycle, addr);
-    // memory->send(request.release());
+void CinnamonMemoryUnit::handleScalarLoad(SST::Cycle_t currentCycle, size_t memRequestIndex, Interfaces::StandardMem::Addr addr, std::size_t size) {
+
+    auto memRequestPtr = &(memRequest[memRequestIndex]);
+    const size_t chunk = transferChunkSize(size);
+    for (size_t i = 0; i < size; i += chunk) {
+        // Scalars are not a multiple of requestWidth. The last request is trimmed in both modes
+        size_t requestSize = std::min(chunk, size - i);
+        auto request = std::make_unique<Interfaces::StandardMem::Read>(addr + i, requestSize);
+        outstandingRequestID[request->getID()] = OutstandingRequest{memRequestPtr, requestSize};
+        stats_.requestsSent++;
+        output->verbose(CALL_INFO, 5, 0, "%s: %lu Issued Scalar Read for address 0x%" PRIx64 "\n",
+                        pe->getName().c_str(), currentCycle, addr + i);
+        memory->send(request.release());
+    }
+    memRequestPtr->requestSize = size;
+    memRequestPtr->bytesProcessed = 0;
+    stats_.scalarLoadsIssued++;
+    stats_.scalarBursts++;
+}
+
+bool CinnamonMemoryUnit::prefetch(Interfaces::StandardMem::Addr addr, std::size_t size) {
+    if (prefetchBuffer.find(addr) != prefetchBuffer.end()) {
+        return true;
+    }
+    if (prefetchBuffer.size() >= config.prefetchBufferSize) {
+        return false;
+    }
+    PrefetchEntry entry;
+    entry.size = size;
+    prefetchBuffer[addr] = entry;
+    prefetchQueue.push_back(addr);
+    stats_.maxPrefetchBufferOccupancy = std::max(stats_.maxPrefetchBufferOccupancy, prefetchBuffer.size());
+    return true;
+}
+
+void CinnamonMemoryUnit::issuePrefetches(SST::Cycle_t currentCycle) {
+    // Prefetches use the MSHRs left over by demand loads and stores and always leave one for them
+    while (!prefetchQueue.empty() && canIssue(true) && (config.numMSHRs == 1 || mshrAllocator.allocated() + 1 < config.numMSHRs)) {
+        auto addr = prefetchQueue.front();
+        prefetchQueue.pop_front();
+        auto &entry = prefetchBuffer.at(addr);
+        auto i = mshrAllocator.allocate();
+        handleVectorLoad(currentCycle, i, addr, entry.size);
+        entry.state = PrefetchEntry::State::InFlight;
+        entry.mshr = i;
+
+        memRequest[i].issuedAtCycle = currentCycle;
+        memRequest[i].busyWith = nullptr;
+        memRequest[i].addr = addr;
+        memRequest[i].responseReceived = false;
+        activeMSHRs.push_back(i);
+        outstandingLoads++;
+        markBusy(addr);
+        stats_.prefetchesIssued++;
+        stats_.maxMSHRsInUse = std::max(stats_.maxMSHRsInUse, mshrAllocator.allocated());
+        output->verbose(CALL_INFO, 4, 0, "%s: %lu Issuing Prefetch for address 0x%" PRIx64 "\n", pe->getName().c_str(), currentCycle, addr);
+    }
+}
+
+bool CinnamonMemoryUnit::claimPrefetch(const std::shared_ptr<CinnamonMemoryInstruction> &instruction) {
+    auto it = prefetchBuffer.find(instruction->getAddr());
+    if (it == prefetchBuffer.end()) {
+        return false;
+    }
+    auto entry = it->second;
+    prefetchBuffer.erase(it);
+    switch (entry.state) {
+    case PrefetchEntry::State::Pending:
+        // The load was dispatched before its prefetch got an MSHR
+        prefetchQueue.remove(instruction->getAddr());
+        stats_.prefetchesCancelled++;
+        return false;
+    case PrefetchEntry::State::InFlight:
+        memRequest[entry.mshr].busyWith = instruction;
+        claimedLoads[instruction->getAddr()] = instruction;
+        stats_.prefetchLateHits++;
+        output->verbose(CALL_INFO, 4, 0, "%s: Load waits for prefetch in flight: %s\n", pe->getName().c_str(), instruction->getString().c_str());
+        return true;
+    case PrefetchEntry::State::Ready:
+        instruction->setExecutionComplete();
+        stats_.prefetchHits++;
+        output->verbose(CALL_INFO, 4, 0, "%s: Load served from prefetch buffer: %s\n", pe->getName().c_str(), instruction->getString().c_str());
+        return true;
+    }
+    return false;
+}
+
+void CinnamonMemoryUnit::invalidatePrefetch(Interfaces::StandardMem::Addr addr) {
+    auto it = prefetchBuffer.find(addr);
+    if (it == prefetchBuffer.end()) {
+        return;
+    }
+    if (it->second.state == PrefetchEntry::State::Pending) {
+        prefetchQueue.remove(addr);
+    }
+    prefetchBuffer.erase(it);
+    stats_.prefetchesDropped++;
+}
+
+bool CinnamonMemoryUnit::idle(Interfaces::StandardMem::Addr addr) const {
+    return busyLimbs.count(addr) == 0;
+}
+
+void CinnamonMemoryUnit::hold(const CinnamonMemoryInstruction &instruction) {
+    instruction.forEachLimb([&](Interfaces::StandardMem::Addr limb) { markBusy(limb); });
+}
+
+void CinnamonMemoryUnit::release(const CinnamonMemoryInstruction &instruction) {
+    instruction.forEachLimb([&](Interfaces::StandardMem::Addr limb) { markIdle(limb); });
+}
+
+void CinnamonMemoryUnit::addLocalRead(const std::shared_ptr<CinnamonMemoryInstruction> &instruction, SST::Cycle_t readyCycle, const std::shared_ptr<CinnamonMemoryInstruction> &waitFor) {
+    localReads.push_back(LocalRead{instruction, readyCycle, waitFor});
 }
 
 bool CinnamonMemoryUnit::okayToFinish() {
-    if (!loadQueue.empty() || !storeQueue.empty()) {
+    if (!loadQueue.empty() || !storeQueue.empty() || !scalarQueue.empty() || !localReads.empty()) {
         return false;
-    } else {
-        for (size_t i = 0; i < NumConcurrentRequests; i++) {
-            if (memRequest[i].busyWith != nullptr) {
-                return false;
-            }
-        }
     }
-    return true;
+    return activeMSHRs.empty();
+}
+
+void CinnamonMemoryUnit::addReplayedActivity(uint64_t loads, uint64_t stores, SST::Cycle_t busyCycles, SST::Cycle_t latency) {
+    stats_.loadsIssued += loads;
+    stats_.storesIssued += stores;
+    stats_.busyCycles += busyCycles;
+    stats_.totalLatency += latency;
 }
 
 std::string CinnamonMemoryUnit::printStats() {
@@ -257,8 +666,44 @@ std::string CinnamonMemoryUnit::printStats() {
     s << "\tLoad Executed : " << stats_.loadsIssued << "\n";
     s << "\tStores Executed: " << stats_.storesIssued << "\n";
     s << "\tMax Latency: " << stats_.maxLatency << "\n";
-    double avgLatency = double(stats_.totalLatency) / (stats_.loadsIssued + stats_.storesIssued);
+    s << "\tScalar Loads Executed: " << stats_.scalarLoadsIssued << "\n";
+    s << "\tScalar Bursts: " << stats_.scalarBursts << "\n";
+    s << "\tScalar Loads Coalesced: " << stats_.scalarLoadsIssued - stats_.scalarBursts << "\n";
+    double avgLatency = double(stats_.totalLatency) / (stats_.loadsIssued + stats_.storesIssued + stats_.scalarLoadsIssued);
     s << "\tAverage Latency: " << avgLatency << "\n";
+    s << "\tMemory Requests Sent: " << stats_.requestsSent << "\n";
+    s << "\tMSHRs: " << config.numMSHRs << "\n";
+    s << "\tMax MSHRs In Use: " << stats_.maxMSHRsInUse << "\n";
+    double avgOccupancy = stats_.totalCycles ? double(stats_.mshrOccupancy) / stats_.totalCycles : 0.0;
+    s << "\tAverage MSHRs In Use: " << avgOccupancy << "\n";
+    s << "\tMSHR Full Cycles: " << stats_.mshrFullCycles << "\n";
+    if (config.prefetchBufferSize > 0) {
+        s << "\tPrefetch Buffer Size: " << config.prefetchBufferSize << "\n";
+        s << "\tMax Prefetch Buffer Occupancy: " << stats_.maxPrefetchBufferOccupancy << "\n";
+        s << "\tPrefetches Issued: " << stats_.prefetchesIssued << "\n";
+        s << "\tPrefetch Hits: " << stats_.prefetchHits << "\n";
+        s << "\tPrefetch Late Hits: " << stats_.prefetchLateHits << "\n";
+        s << "\tPrefetches Cancelled: " << stats_.prefetchesCancelled << "\n";
+        s << "\tPrefetches Unused: " << stats_.prefetchesDropped + prefetchBuffer.size() << "\n";
+    }
+    auto capacity = [](size_t c) { return c ? std::to_string(c) : std::string("unbounded"); };
+    s << "\tLoad Queue Capacity: " << capacity(config.loadQueueCapacity) << "\n";
+    s << "\tMax Load Queue Occupancy: " << stats_.maxLoadQueueOccupancy << "\n";
+    s << "\tAverage Load Queue Occupancy: " << (stats_.totalCycles ? double(stats_.loadQueueOccupancy) / stats_.totalCycles : 0.0) << "\n";
+    s << "\tLoad Queue Full Dispatch Stalls: " << stats_.loadQueueFullStalls << "\n";
+    s << "\tStore Queue Capacity: " << capacity(config.storeQueueCapacity) << "\n";
+    s << "\tMax Store Queue Occupancy: " << stats_.maxStoreQueueOccupancy << "\n";
+    s << "\tAverage Store Queue Occupancy: " << (stats_.totalCycles ? double(stats_.storeQueueOccupancy) / stats_.totalCycles : 0.0) << "\n";
+    s << "\tStore Queue Full Dispatch Stalls: " << stats_.storeQueueFullStalls << "\n";
+    s << "\tScalar Queue Capacity: " << capacity(config.scalarQueueCapacity) << "\n";
+    s << "\tMax Scalar Queue Occupancy: " << stats_.maxScalarQueueOccupancy << "\n";
+    s << "\tScalar Queue Full Dispatch Stalls: " << stats_.scalarQueueFullStalls << "\n";
+    s << "\tSpills Quashed Before Issue: " << stats_.spillsQuashed << "\n";
+    if (config.arbitration == Config::Arbitration::DeferSpills) {
+        s << "\tSpills Deferred: " << stats_.spillsDeferred << "\n";
+        s << "\tDeferred Spills Quashed: " << stats_.deferredSpillsQuashed << "\n";
+        s << "\tDeferred Spill Wait Cycles: " << stats_.spillDeferCycles << "\n";
+    }
     return s.str();
 }
 
@@ -3,12 +3,15 @@
 #define _H_SST_CINNAMON_MEMORY_UNIT
 
 #include <list>
+#include <map>
 #include <queue>
+#include <unordered_map>
 
 #include "accelerator.h"
 #include "instruction.h"
 #include "physicalRegister.h"
 #include "sst/core/interfaces/stdMem.h"
+#include "utils/allocator.h"
 #include "utils/utils.h"
 #include <sst/core/component.h>
 
@@ -17,26 +20,111 @@ namespace Cinnamon {
 
 class CinnamonMemoryUnit {
 
+public:
+    struct Config {
+        size_t requestWidth = 1024;
+        size_t numMSHRs = 2;
+        size_t maxOutstandingLoads = 2;
+        size_t maxOutstandingStores = 2;
+        bool inOrderCompletion = false;
+        // Send each transfer as requests of bulkTransferSize bytes instead of requestWidth bytes.
+        // A bulkTransferSize of zero sends the whole transfer as a single request
+        bool bulkTransfers = false;
+        size_t bulkTransferSize = 0;
+        // Number of limbs the prefetch buffer holds. Zero disables prefetching
+        size_t prefetchBufferSize = 0;
+        // Adjacent queued scalar loads are issued together as one transfer of up to scalarBurstSize bytes.
+        // Zero issues each scalar load on its own
+        size_t scalarBurstSize = 0;
+
+        enum class Arbitration {
+            LoadsFirst,  // All ready loads, then all ready stores and spills
+            Age,         // Oldest ready transfer first
+            Deadline,    // Loads whose consumers are waiting, then stores and spills under register pressure
+            DeferSpills, // Loads first. Spills wait for store queue or register pressure
+        };
+        Arbitration arbitration = Arbitration::LoadsFirst;
+        // Entries in the load, store and scalar queues. Zero leaves a queue unbounded
+        size_t loadQueueCapacity = 0;
+        size_t storeQueueCapacity = 0;
+        size_t scalarQueueCapacity = 0;
+        size_t storeQueueWatermark = 8;
+        size_t freeRegisterWatermark = 16;
+        SST::Cycle_t spillDeferLimit = 10000;
+    };
+    static Config::Arbitration parseArbitration(const std::string &arbitration);
+
+private:
     CinnamonChip *pe;
     CinnamonAccelerator *accelerator;
     std::shared_ptr<SST::Output> output;
-    std::list<std::shared_ptr<CinnamonMemoryInstruction>> loadQueue;
-    std::list<std::shared_ptr<CinnamonMemoryInstruction>> storeQueue;
+    using MemoryQueue = std::list<std::shared_ptr<CinnamonMemoryInstruction>>;
+    MemoryQueue loadQueue;
+    MemoryQueue storeQueue;
+    MemoryQueue scalarQueue; // Scalar loads. Issued ahead of vector loads and share their limit
+    // Address of each limb of a queued instruction to its queue entry. Entries with the same address are
+    // kept in program order, so the last entry of an address is its youngest instruction
+    using AliasIndex = std::multimap<Interfaces::StandardMem::Addr, MemoryQueue::iterator>;
+    AliasIndex loadIndex;
+    AliasIndex storeIndex;
+    AliasIndex scalarIndex;
+    // Queued and in flight transfers of each limb, so freed limbs can be reclaimed without scanning the queues
+    std::unordered_map<Interfaces::StandardMem::Addr, size_t> busyLimbs;
     Interfaces::StandardMem *memory; // Interface to Memory
     // Interfaces::StandardMem::Request::id_t outstandingRequestID;
     size_t requestWidth = 64;
-    size_t NumConcurrentRequests = 2;
+    Config config;
 
+    // Miss status holding registers. Each tracks one limb transfer in flight
     struct MemRequest {
         size_t bytesProcessed = 0;
         size_t requestSize = 0;
         SST::Cycle_t issuedAtCycle = 0;
         std::uint16_t cyclesToCompletion = 0;
         bool responseReceived = false;
-        std::shared_ptr<CinnamonMemoryInstruction> busyWith = nullptr;
-    } memRequest[2];
+        std::shared_ptr<CinnamonMemoryInstruction> busyWith = nullptr; // nullptr while prefetching
+        Interfaces::StandardMem::Addr addr = 0;
+    };
+    std::vector<MemRequest> memRequest;
+    Utils::PoolAllocator mshrAllocator;
+    std::list<uint32_t> activeMSHRs; // In issue order
+    size_t outstandingLoads = 0;
+    size_t outstandingStores = 0;
+
+    struct OutstandingRequest {
+        MemRequest *mshr;
+        size_t size;
+    };
+    std::unordered_map<Interfaces::StandardMem::Request::id_t, OutstandingRequest> outstandingRequestID;
+
+    // Prefetch buffer. Entries are allocated when a prefetch is requested and freed when the
+    // prefetched limb is claimed by a load or invalidated
+    struct PrefetchEntry {
+        enum class State {
+            Pending, // Waiting for an MSHR
+            InFlight,
+            Ready
+        };
+        State state = State::Pending;
+        size_t size = 0;
+        uint32_t mshr = 0;
+    };
+    std::unordered_map<Interfaces::StandardMem::Addr, PrefetchEntry> prefetchBuffer;
+    std::list<Interfaces::StandardMem::Addr> prefetchQueue; // Pending prefetches in request order
+    // Loads waiting for the prefetch in flight they claimed. Later loads of the limb forward from them
+    std::unordered_map<Interfaces::StandardMem::Addr, std::shared_ptr<CinnamonMemoryInstruction>> claimedLoads;
+    void issuePrefetches(SST::Cycle_t currentCycle);
 
-    std::unordered_map<Interfaces::StandardMem::Request::id_t, MemRequest *> outstandingRequestID;
+    // Loads served by the scratchpad
+    struct LocalRead {
+        std::shared_ptr<CinnamonMemoryInstruction> instruction;
+        SST::Cycle_t readyCycle;
+        std::shared_ptr<CinnamonMemoryInstruction> waitFor; // Load still filling the limb
+    };
+    std::list<LocalRead> localReads;
+
+    // Size of the requests a transfer of size bytes is split into
+    size_t transferChunkSize(std::size_t size) const;
 
     // SST::Cycle_t busyCycles;
     // SST::Cycle_t totalCycles;
@@ -44,21 +132,69 @@ class CinnamonMemoryUnit {
     struct Stats {
         uint64_t loadsIssued = 0;
         uint64_t storesIssued = 0;
+        uint64_t scalarLoadsIssued = 0;
+        uint64_t scalarBursts = 0;
+        size_t maxScalarQueueOccupancy = 0;
         SST::Cycle_t totalCycles = 0;
         SST::Cycle_t busyCycles = 0;
         SST::Cycle_t totalLatency = 0;
         SST::Cycle_t maxLatency = 0;
         SST::Cycle_t busyCyclesWindow = 0;
+        uint64_t mshrOccupancy = 0;
+        size_t maxMSHRsInUse = 0;
+        SST::Cycle_t mshrFullCycles = 0;
+        uint64_t requestsSent = 0;
+        uint64_t prefetchesIssued = 0;
+        uint64_t prefetchHits = 0;
+        uint64_t prefetchLateHits = 0;
+        uint64_t prefetchesCancelled = 0;
+        uint64_t prefetchesDropped = 0;
+        size_t maxPrefetchBufferOccupancy = 0;
+        uint64_t loadQueueOccupancy = 0;
+        uint64_t storeQueueOccupancy = 0;
+        size_t maxLoadQueueOccupancy = 0;
+        size_t maxStoreQueueOccupancy = 0;
+        SST::Cycle_t loadQueueFullStalls = 0;
+        SST::Cycle_t storeQueueFullStalls = 0;
+        SST::Cycle_t scalarQueueFullStalls = 0;
+        uint64_t spillsQuashed = 0;
+        uint64_t deferredSpillsQuashed = 0;
+        uint64_t spillsDeferred = 0;
+        SST::Cycle_t spillDeferCycles = 0;
     } stats_;
 
+    bool canIssue(bool load) const;
+    uint64_t nextSequence = 0;
+    SST::Cycle_t lastCycle = 0;
+    bool draining = false;
+    // Oldest instruction of the queue that can be issued. Spills held back by deferSpills are skipped
+    MemoryQueue::iterator nextReady(MemoryQueue &queue, SST::Cycle_t currentCycle);
+    void issue(SST::Cycle_t currentCycle, MemoryQueue &queue, MemoryQueue::iterator it);
+    bool spillDeferred(const CinnamonMemoryInstruction &instruction, SST::Cycle_t currentCycle) const;
+    bool registerPressure() const;
+    // True if a dispatched instruction reads a register the load writes
+    bool hasWaitingConsumer(CinnamonMemoryInstruction &load);
+    // Issues ready transfers from both queues in the order of the arbitration policy
+    void arbitrate(SST::Cycle_t currentCycle);
+    AliasIndex &indexOf(const MemoryQueue &queue);
+    // Indexes the queue entry under the address of every limb it transfers
+    void addToIndex(AliasIndex &index, MemoryQueue::iterator entry);
+    void removeFromIndex(AliasIndex &index, MemoryQueue::iterator entry);
+    void markBusy(Interfaces::StandardMem::Addr addr);
+    void markIdle(Interfaces::StandardMem::Addr addr);
+    // Merges the queued scalar loads that directly follow the leader in memory into it
+    void coalesceScalars(const std::shared_ptr<CinnamonMemoryInstruction> &leader);
+    void completeRequest(uint32_t mshr, SST::Cycle_t currentCycle);
+
 public:
     // CinnamonMemoryUnit(Interfaces::StandardMem * memory);
-    CinnamonMemoryUnit(CinnamonChip *pe, CinnamonAccelerator *accelerator, const uint32_t outputLevel, Interfaces::StandardMem *memory, size_t requestWidth);
+    CinnamonMemoryUnit(CinnamonChip *pe, CinnamonAccelerator *accelerator, const uint32_t outputLevel, Interfaces::StandardMem *memory, const Config &config);
     std::shared_ptr<PhysicalRegister> findLoadAlias(Interfaces::StandardMem::Addr addr);
     std::shared_ptr<PhysicalRegister> findStoreAlias(Interfaces::StandardMem::Addr addr, bool quashAliasingStore);
     void addToLoadQueue(std::shared_ptr<CinnamonMemoryInstruction>);
     void addToStoreQueue(std::shared_ptr<CinnamonMemoryInstruction>);
-    bool operateQueue(SST::Cycle_t currentCycle, std::list<std::shared_ptr<CinnamonMemoryInstruction>> &queue, const std::string &queueName);
+    void addToScalarQueue(std::shared_ptr<CinnamonMemoryInstruction>);
+    bool operateQueue(SST::Cycle_t currentCycle, std::list<std::shared_ptr<CinnamonMemoryInstruction>> &queue);
     void executeCycleBegin(SST::Cycle_t currentCycle);
     void executeCycleEnd(SST::Cycle_t currentCycle);
     void init(unsigned int phase);
@@ -66,8 +202,86 @@ public:
     void handleResponse(SST::Interfaces::StandardMem::Request *ev);
     void handleVectorLoad(SST::Cycle_t currentCycle, size_t memRequestIndex, Interfaces::StandardMem::Addr addr, std::size_t size);
     void handleVectorStore(SST::Cycle_t currentCycle, size_t memRequestIndex, Interfaces::StandardMem::Addr addr, std::size_t size);
-    void handleScalarLoad(SST::Cycle_t currentCycle, Interfaces::StandardMem::Addr addr, std::size_t size);
+    void handleScalarLoad(SST::Cycle_t currentCycle, size_t memRequestIndex, Interfaces::StandardMem::Addr addr, std::size_t size);
     bool okayToFinish();
+    // No more instructions will be dispatched. Held back spills are released
+    void drain() {
+        draining = true;
+    }
+
+    // Lookahead prefetching
+    bool hasLoadAlias(Interfaces::StandardMem::Addr addr) const {
+        return loadIndex.count(addr) != 0 || scalarIndex.count(addr) != 0 || claimedLoads.count(addr) != 0;
+    }
+    bool hasStoreAlias(Interfaces::StandardMem::Addr addr) const {
+        return storeIndex.count(addr) != 0;
+    }
+    // Requests a prefetch of the limb at addr. Returns false if the prefetch buffer is full
+    bool prefetch(Interfaces::StandardMem::Addr addr, std::size_t size);
+    // Serves a dispatched load from the prefetch buffer. A ready limb completes the load at once and a
+    // limb in flight completes it when it arrives. Returns false if the load must be queued as usual
+    bool claimPrefetch(const std::shared_ptr<CinnamonMemoryInstruction> &instruction);
+    // Drops a prefetched limb whose memory is about to be overwritten or that is no longer needed
+    void invalidatePrefetch(Interfaces::StandardMem::Addr addr);
+
+    // True if no queued, held or in flight transfer touches the limb at addr
+    bool idle(Interfaces::StandardMem::Addr addr) const;
+    // Keeps the limbs of an instruction held outside the memory unit queues busy, while it waits in an
+    // open limb group or the fast-forward queue, until it is released
+    void hold(const CinnamonMemoryInstruction &instruction);
+    void release(const CinnamonMemoryInstruction &instruction);
+
+    // Completes a load at readyCycle without a memory transfer, once waitFor (if any) has completed
+    void addLocalRead(const std::shared_ptr<CinnamonMemoryInstruction> &instruction, SST::Cycle_t readyCycle, const std::shared_ptr<CinnamonMemoryInstruction> &waitFor);
+    std::size_t loadQueueSize() const {
+        return loadQueue.size();
+    }
+    std::size_t scalarQueueSize() const {
+        return scalarQueue.size();
+    }
+    std::size_t storeQueueSize() const {
+        return storeQueue.size();
+    }
+    bool loadQueueFull() const {
+        return config.loadQueueCapacity > 0 && loadQueue.size() >= config.loadQueueCapacity;
+    }
+    bool storeQueueFull() const {
+        return config.storeQueueCapacity > 0 && storeQueue.size() >= config.storeQueueCapacity;
+    }
+    bool scalarQueueFull() const {
+        return config.scalarQueueCapacity > 0 && scalarQueue.size() >= config.scalarQueueCapacity;
+    }
+    // Counts a cycle in which dispatch stalled because the load or store queue was full
+    void recordDispatchStall(bool load) {
+        if (load) {
+            stats_.loadQueueFullStalls++;
+        } else {
+            stats_.storeQueueFullStalls++;
+        }
+    }
+    // Counts a cycle in which dispatch stalled because the scalar queue was full
+    void recordScalarDispatchStall() {
+        stats_.scalarQueueFullStalls++;
+    }
+    // True if a prefetched limb is in flight or ready, so a load of addr needs no queue entry
+    bool prefetched(Interfaces::StandardMem::Addr addr) const {
+        auto it = prefetchBuffer.find(addr);
+        return it != prefetchBuffer.end() && it->second.state != PrefetchEntry::State::Pending;
+    }
+    uint64_t loadsIssued() const {
+        return stats_.loadsIssued;
+    }
+    uint64_t storesIssued() const {
+        return stats_.storesIssued;
+    }
+    SST::Cycle_t busyCycles() const {
+        return stats_.busyCycles;
+    }
+    SST::Cycle_t totalLatency() const {
+        return stats_.totalLatency;
+    }
+    // Accounts for memory traffic that was not simulated cycle by cycle
+    void addReplayedActivity(uint64_t loads, uint64_t stores, SST::Cycle_t busyCycles, SST::Cycle_t latency);
     std::string printStats();
 };
 } // Namespace Cinnamon
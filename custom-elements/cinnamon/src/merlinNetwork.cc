@@ -0,0 +1,168 @@
+// Copyright (c) Siddharth Jayashankar. All rights reserved.
+#include "merlinNetwork.h"
+#include "accelerator.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace SST {
+namespace Cinnamon {
+
+CinnamonMerlinNetwork::CinnamonMerlinNetwork(ComponentId_t id, Params &params, CinnamonAccelerator *accelerator, size_t numChips) : CinnamonNetwork(id, params, accelerator, numChips) {
+
+    packetSize = params.find<uint64_t>("packetSize", 2048);
+    if (packetSize == 0) {
+        output->fatal(CALL_INFO, -1, "%s: packetSize must be non-zero\n", getName().c_str());
+    }
+
+    for (size_t chipID = 0; chipID < numChips; chipID++) {
+        auto endpoint = loadUserSubComponentByIndex<Interfaces::SimpleNetwork>("endpoint", chipID, ComponentInfo::SHARE_NONE, 1 /* Virtual networks */);
+        if (!endpoint) {
+            output->fatal(CALL_INFO, -1, "%s: Unable to load endpoint %zu. Fill the endpoint slot with a SimpleNetwork for every chip\n", getName().c_str(), chipID);
+        }
+        endpoint->setNotifyOnReceive(new Interfaces::SimpleNetwork::Handler<CinnamonMerlinNetwork, int>(this, &CinnamonMerlinNetwork::handleReceive, chipID));
+        endpoint->setNotifyOnSend(new Interfaces::SimpleNetwork::Handler<CinnamonMerlinNetwork, int>(this, &CinnamonMerlinNetwork::handleSpaceToSend, chipID));
+        endpoints.push_back(endpoint);
+    }
+    endpointIDs.resize(numChips);
+    sendQueues.resize(numChips);
+}
+
+CinnamonMerlinNetwork::~CinnamonMerlinNetwork() {}
+
+void CinnamonMerlinNetwork::init(unsigned int phase) {
+    for (auto endpoint : endpoints) {
+        endpoint->init(phase);
+    }
+}
+
+void CinnamonMerlinNetwork::setup() {
+    for (size_t chipID = 0; chipID < numChips; chipID++) {
+        endpoints[chipID]->setup();
+        endpointIDs[chipID] = endpoints[chipID]->getEndpointID();
+    }
+}
+
+void CinnamonMerlinNetwork::finish() {
+    for (auto endpoint : endpoints) {
+        endpoint->finish();
+    }
+}
+
+void CinnamonMerlinNetwork::routeInput(uint64_t syncID, int portID) {
+    auto &syncOp = syncOps.at(syncID);
+    const uint64_t bytes = syncOp.bytes();
+    auto operation = syncOp.operation();
+    if (operation == OpType::Brc) {
+        for (auto &i : syncOp.broadcastDestinations()) {
+            if (i == portID) {
+                continue;
+            }
+            send(portID, i, syncID, bytes);
+        }
+    } else if (operation == OpType::Agg) {
+        auto aggregationDestination = syncOp.aggregationDestination();
+        assert(aggregationDestination != -1);
+        if (aggregationDestination != portID) {
+            send(portID, aggregationDestination, syncID, bytes);
+        }
+        if (syncOp.inputsPending() == 0) {
+            tryDeliver(syncID, aggregationDestination);
+        }
+    } else if (isExchange(operation)) {
+        for (auto &i : syncOp.participants()) {
+            if (i != portID) {
+                send(portID, i, syncID, syncOp.pieceBytes());
+            }
+        }
+        if (syncOp.inputsPending() == 0) {
+            // Delivering to the last participant completes the sync, so iterate over a copy
+            auto participants = syncOp.participants();
+            for (auto &i : participants) {
+                tryDeliver(syncID, i);
+            }
+        }
+    } else {
+        throw std::runtime_error("Unimplement Network Operation");
+    }
+}
+
+void CinnamonMerlinNetwork::send(size_t src, size_t dst, uint64_t syncID, uint64_t bytes) {
+    bytesInFlight[{syncID, dst}] += bytes;
+    for (uint64_t sent = 0; sent < bytes; sent += packetSize) {
+        sendQueues[src].push_back(Packet{syncID, dst, std::min(packetSize, bytes - sent)});
+    }
+    merlinStats_.maxSendQueue = std::max(merlinStats_.maxSendQueue, sendQueues[src].size());
+    inject(src);
+}
+
+void CinnamonMerlinNetwork::inject(size_t chipID) {
+    auto &queue = sendQueues[chipID];
+    while (!queue.empty()) {
+        auto &packet = queue.front();
+        const int bits = packet.bytes * 8;
+        if (!endpoints[chipID]->spaceToSend(0, bits)) {
+            merlinStats_.injectionStalls++;
+            return; // Resumed by handleSpaceToSend
+        }
+        auto request = new Interfaces::SimpleNetwork::Request(endpointIDs[packet.destination], endpointIDs[chipID], bits, true, true);
+        request->givePayload(new CinnamonNetworkEvent(packet.syncID));
+        endpoints[chipID]->send(request, 0);
+        merlinStats_.packetsSent++;
+        merlinStats_.bytesSent += packet.bytes;
+        queue.pop_front();
+    }
+}
+
+bool CinnamonMerlinNetwork::handleSpaceToSend(int, int chipID) {
+    inject(chipID);
+    return true; // Keep the handler registered
+}
+
+bool CinnamonMerlinNetwork::handleReceive(int vn, int chipID) {
+    while (auto request = endpoints[chipID]->recv(vn)) {
+        std::unique_ptr<CinnamonNetworkEvent> networkEvent(static_cast<CinnamonNetworkEvent *>(request->takePayload()));
+        const uint64_t bytes = request->size_in_bits / 8;
+        delete request;
+        merlinStats_.packetsReceived++;
+
+        auto syncID = networkEvent->syncID();
+        auto it = bytesInFlight.find({syncID, static_cast<size_t>(chipID)});
+        if (it == bytesInFlight.end() || it->second < bytes) {
+            output->fatal(CALL_INFO, -1, "%s: %lu Received Spurious Packet for syncID: %lu at chip %d\n", getName().c_str(), accelerator->getCurrentSimTime(), syncID, chipID);
+        }
+        it->second -= bytes;
+        if (it->second == 0) {
+            bytesInFlight.erase(it);
+            tryDeliver(syncID, chipID);
+        }
+    }
+    return true;
+}
+
+void CinnamonMerlinNetwork::tryDeliver(uint64_t syncID, size_t chipID) {
+    auto it = syncOps.find(syncID);
+    if (it == syncOps.end() || bytesInFlight.count({syncID, chipID})) {
+        return;
+    }
+    // Partial sums and exchanged pieces of chips whose input has not reached the network are still to come
+    if (it->second.operation() != OpType::Brc && it->second.inputsPending() != 0) {
+        return;
+    }
+    output->verbose(CALL_INFO, 4, 0, "%s: %lu Delivering syncID : %lu to chip: %zu\n", getName().c_str(), accelerator->getCurrentSimCycle(), syncID, chipID);
+    deliver(syncID, chipID, 0);
+}
+
+std::string CinnamonMerlinNetwork::printStats() const {
+    std::stringstream s;
+    s << CinnamonNetwork::printStats();
+    s << "\tPackets Sent: " << merlinStats_.packetsSent << "\n";
+    s << "\tPackets Received: " << merlinStats_.packetsReceived << "\n";
+    s << "\tBytes Sent: " << merlinStats_.bytesSent << "\n";
+    s << "\tInjection Stalls: " << merlinStats_.injectionStalls << "\n";
+    s << "\tMax Send Queue (packets): " << merlinStats_.maxSendQueue << "\n";
+    return s.str();
+}
+
+} // namespace Cinnamon
+} // namespace SST
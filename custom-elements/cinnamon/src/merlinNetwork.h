@@ -0,0 +1,90 @@
+// Copyright (c) Siddharth Jayashankar. All rights reserved.
+#ifndef _H_SST_CINNAMON_MERLIN_NETWORK
+#define _H_SST_CINNAMON_MERLIN_NETWORK
+
+#include <deque>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "network.h"
+#include "sst/core/interfaces/simpleNetwork.h"
+
+namespace SST {
+namespace Cinnamon {
+
+// Network that sends the data of every sync as packets through a SimpleNetwork (e.g. merlin).
+// Each chip owns one endpoint, loaded into index chipID of the endpoint slot. A broadcast sends the
+// source's value to every destination and an aggregation sends every partial sum to the destination.
+// In an exchange every participant sends its value (all-gather) or the share of it owned by each other participant
+// (reduce-scatter, all-to-all) straight to the other participants.
+// A chip receives the result of a sync once all of its packets have been ejected at its endpoint.
+// The routers, buffers and flow control are those of the configured SimpleNetwork
+class CinnamonMerlinNetwork : public CinnamonNetwork {
+public:
+    CinnamonMerlinNetwork(ComponentId_t id, Params &params, CinnamonAccelerator *accelerator, size_t numChips);
+    ~CinnamonMerlinNetwork();
+
+    void init(unsigned int phase) override;
+    void setup() override;
+    void finish() override;
+
+    SST_ELI_REGISTER_SUBCOMPONENT(
+        CinnamonMerlinNetwork,
+        "cinnamon",
+        "MerlinNetwork",
+        SST_ELI_ELEMENT_VERSION(1, 0, 0),
+        "Cinnamon Network backed by a SimpleNetwork such as merlin",
+        SST::Cinnamon::CinnamonNetwork);
+
+    SST_ELI_DOCUMENT_PARAMS(
+        {"verbose", "Verbosity for debugging. Increased numbers for increased verbosity.", "0"},
+        {"packetSize", "Largest packet in bytes a transfer is split into", "2048"}, )
+
+    SST_ELI_DOCUMENT_PORTS(
+        {"chip_port_%(numChips)d", "Ports which connect to chips.", {}})
+
+    SST_ELI_DOCUMENT_SUBCOMPONENT_SLOTS(
+        {"endpoint", "Network interface of each chip, e.g. merlin.linkcontrol. Index i belongs to chip i", "SST::Interfaces::SimpleNetwork"})
+
+    std::string printStats() const override;
+
+protected:
+    void routeInput(uint64_t syncID, int portID) override;
+
+private:
+    struct Packet {
+        uint64_t syncID;
+        size_t destination;
+        uint64_t bytes;
+    };
+
+    std::vector<Interfaces::SimpleNetwork *> endpoints;
+    std::vector<Interfaces::SimpleNetwork::nid_t> endpointIDs;
+    std::vector<std::deque<Packet>> sendQueues;
+    // Bytes of a sync that have not yet arrived at a destination chip
+    std::map<std::pair<uint64_t, size_t>, uint64_t> bytesInFlight;
+    uint64_t packetSize;
+
+    // Queues a transfer from src to dst as packets
+    void send(size_t src, size_t dst, uint64_t syncID, uint64_t bytes);
+    // Injects queued packets of a chip until its endpoint has no space left
+    void inject(size_t chipID);
+    // Delivers the result of a sync to a chip once nothing more is on the way to it
+    void tryDeliver(uint64_t syncID, size_t chipID);
+    bool handleSpaceToSend(int vn, int chipID);
+    bool handleReceive(int vn, int chipID);
+
+    struct Stats {
+        uint64_t packetsSent = 0;
+        uint64_t packetsReceived = 0;
+        uint64_t bytesSent = 0;
+        uint64_t injectionStalls = 0;
+        size_t maxSendQueue = 0;
+    } merlinStats_;
+};
+
+} // namespace Cinnamon
+} // namespace SST
+
+#endif // _H_SST_CINNAMON_MERLIN_NETWORK
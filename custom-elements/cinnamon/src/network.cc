@@ -2,6 +2,8 @@
 #include "network.h"
 #include "accelerator.h"
 
+#include <algorithm>
+
 namespace SST {
 namespace Cinnamon {
 
@@ -10,10 +12,89 @@ CinnamonNetwork::CinnamonNetwork(ComponentId_t id, Params &params, CinnamonAccel
     const uint32_t output_level = (uint32_t)params.find<uint32_t>("verbose", 0);
     output = std::make_shared<SST::Output>(SST::Output("CinnamonNetwork[@p:@l]: ", output_level, 0, SST::Output::STDOUT));
 
-    hops = params.find<uint32_t>("hops", "2");
-    auto linkBW = params.find<UnitAlgebra>("linkBW");
-    UnitAlgebra limbSize("224KB");
-    UnitAlgebra outputClock = linkBW / limbSize;
+    auto linkBW = params.find<UnitAlgebra>("linkBW", "64GB/s");
+    if (!linkBW.hasUnits("B/s") || linkBW.getDoubleValue() <= 0) {
+        output->fatal(CALL_INFO, -1, "%s: linkBW must be a positive bandwidth in B/s\n", getName().c_str());
+    }
+    psPerByte = 1e12 / linkBW.getDoubleValue();
+
+    auto topologyKind = params.find<std::string>("topology", "legacy");
+    if (topologyKind != "legacy") {
+        auto hopLatency = params.find<UnitAlgebra>("hopLatency", "20ns");
+        if (!hopLatency.hasUnits("s")) {
+            output->fatal(CALL_INFO, -1, "%s: hopLatency must be specified in seconds\n", getName().c_str());
+        }
+        const SimTime_t hopPs = static_cast<SimTime_t>(std::llround(hopLatency.getDoubleValue() * 1e12));
+        chipsPerBoard = params.find<size_t>("chipsPerBoard", 0);
+        try {
+            if (chipsPerBoard == 0 || chipsPerBoard == numChips) {
+                chipsPerBoard = 0;
+                topology = std::make_unique<CinnamonTopology>(CinnamonTopology::parseKind(topologyKind), numChips,
+                                                              params.find<size_t>("torusWidth", 0),
+                                                              psPerByte,
+                                                              hopPs);
+            } else {
+                auto fabricLinkBW = params.find<UnitAlgebra>("fabricLinkBW", "25GB/s");
+                if (!fabricLinkBW.hasUnits("B/s") || fabricLinkBW.getDoubleValue() <= 0) {
+                    output->fatal(CALL_INFO, -1, "%s: fabricLinkBW must be a positive bandwidth in B/s\n", getName().c_str());
+                }
+                auto fabricHopLatency = params.find<UnitAlgebra>("fabricHopLatency", "500ns");
+                if (!fabricHopLatency.hasUnits("s")) {
+                    output->fatal(CALL_INFO, -1, "%s: fabricHopLatency must be specified in seconds\n", getName().c_str());
+                }
+                CinnamonTopology::LevelConfig board{CinnamonTopology::parseKind(topologyKind), params.find<size_t>("torusWidth", 0), psPerByte, hopPs};
+                CinnamonTopology::LevelConfig fabric{CinnamonTopology::parseKind(params.find<std::string>("fabricTopology", "switch")),
+                                                     params.find<size_t>("fabricTorusWidth", 0),
+                                                     1e12 / fabricLinkBW.getDoubleValue(),
+                                                     static_cast<SimTime_t>(std::llround(fabricHopLatency.getDoubleValue() * 1e12))};
+                topology = std::make_unique<CinnamonTopology>(numChips, chipsPerBoard, board, fabric);
+            }
+        } catch (const std::invalid_argument &e) {
+            output->fatal(CALL_INFO, -1, "%s: %s\n", getName().c_str(), e.what());
+        }
+        output->verbose(CALL_INFO, 1, 0, "Configured %s topology with %zu links\n", topologyKind.c_str(), topology->numLinks());
+
+        try {
+            std::map<size_t, CinnamonCollective::Algorithm> thresholds;
+            std::vector<std::string> entries;
+            params.find_array<std::string>("collectiveThresholds", entries);
+            for (auto &entry : entries) {
+                auto colon = entry.find(':');
+                if (colon == std::string::npos) {
+                    throw std::invalid_argument("Malformed collective threshold " + entry + ". Expected size:algorithm");
+                }
+                thresholds[std::stoul(entry.substr(0, colon))] = CinnamonCollective::parseAlgorithm(entry.substr(colon + 1));
+            }
+            collective = std::make_unique<CinnamonCollective>(numChips,
+                                                              CinnamonCollective::parseAlgorithm(params.find<std::string>("collectiveAlgorithm", "direct")),
+                                                              thresholds,
+                                                              params.find<uint64_t>("chunkSize", 0),
+                                                              params.find<bool>("hierarchicalCollectives", true) ? chipsPerBoard : 0);
+        } catch (const std::invalid_argument &e) {
+            output->fatal(CALL_INFO, -1, "%s: %s\n", getName().c_str(), e.what());
+        }
+    }
+
+    if (!topology && params.find<size_t>("chipsPerBoard", 0) != 0) {
+        output->fatal(CALL_INFO, -1, "%s: chipsPerBoard needs a ring, torus2d or switch topology\n", getName().c_str());
+    }
+
+    inNetworkReduction = params.find<bool>("inNetworkReduction", false);
+    if (inNetworkReduction) {
+        if (!topology) {
+            output->fatal(CALL_INFO, -1, "%s: inNetworkReduction needs a ring, torus2d or switch topology\n", getName().c_str());
+        }
+        auto latency = params.find<UnitAlgebra>("reduceLatency", "10ns");
+        auto reduceBW = params.find<UnitAlgebra>("reduceBW", "64GB/s");
+        if (!latency.hasUnits("s")) {
+            output->fatal(CALL_INFO, -1, "%s: reduceLatency must be specified in seconds\n", getName().c_str());
+        }
+        if (!reduceBW.hasUnits("B/s") || reduceBW.getDoubleValue() <= 0) {
+            output->fatal(CALL_INFO, -1, "%s: reduceBW must be a positive bandwidth in B/s\n", getName().c_str());
+        }
+        reduceLatency = static_cast<SimTime_t>(std::llround(latency.getDoubleValue() * 1e12));
+        reducePsPerByte = 1e12 / reduceBW.getDoubleValue();
+    }
 
     std::string port_name_base("chip_port_");
     for (size_t chipID = 0; chipID < numChips; chipID++) {
@@ -24,12 +105,18 @@ CinnamonNetwork::CinnamonNetwork(ComponentId_t id, Params &params, CinnamonAccel
             output->fatal(CALL_INFO, -1, "Unable to load chip Link for port : %s\n", port_name.c_str());
         }
         chipLinks.push_back(link);
-        auto outputTimingLink = configureSelfLink("output_timing_" + std::to_string(chipID), outputClock,
+        auto outputTimingLink = configureSelfLink("output_timing_" + std::to_string(chipID), "1ps",
                                                   new Event::Handler<CinnamonNetwork, int>(this, &CinnamonNetwork::handleOutput, chipID));
         outputTiming.push_back(outputTimingLink);
+        if (topology) {
+            deliveryTiming.push_back(configureSelfLink("delivery_timing_" + std::to_string(chipID), "1ps",
+                                                       new Event::Handler<CinnamonNetwork, int>(this, &CinnamonNetwork::handleDelivery, chipID)));
+        }
     }
 
     outputBWBuffer.resize(numChips);
+    shadowChips.resize(numChips);
+    isShadowChip.resize(numChips, false);
 }
 CinnamonNetwork::~CinnamonNetwork() {}
 
@@ -37,13 +124,31 @@ void CinnamonNetwork::init(unsigned int phase) {}
 void CinnamonNetwork::setup() {}
 void CinnamonNetwork::finish() {}
 
-bool CinnamonNetwork::tryRegisterSync(size_t ChipID, uint64_t syncID, uint64_t syncSize, OpType op, bool sendReply /* Does the network need to send you a value */, bool recvValue /* Are you sending a value to the network*/) {
+void CinnamonNetwork::addShadowChip(size_t representativeID, size_t shadowID) {
+    assert(representativeID < numChips && shadowID < numChips);
+    assert(!isShadowChip[representativeID]);
+    shadowChips[representativeID].push_back(shadowID);
+    isShadowChip[shadowID] = true;
+    output->verbose(CALL_INFO, 2, 0, "Chip %zu replays chip %zu\n", shadowID, representativeID);
+}
+
+bool CinnamonNetwork::tryRegisterSync(size_t ChipID, uint64_t syncID, uint64_t syncSize, uint64_t bytes, OpType op, bool sendReply /* Does the network need to send you a value */, bool recvValue /* Are you sending a value to the network*/) {
+    bool registered = registerSync(ChipID, syncID, syncSize, bytes, op, sendReply, recvValue);
+    if (registered) {
+        for (auto shadowID : shadowChips[ChipID]) {
+            registerSync(shadowID, syncID, syncSize, bytes, op, sendReply, recvValue);
+        }
+    }
+    return registered;
+}
+
+bool CinnamonNetwork::registerSync(size_t ChipID, uint64_t syncID, uint64_t syncSize, uint64_t bytes, OpType op, bool sendReply, bool recvValue) {
     std::unique_lock lock(mtx);
     if (syncOps.find(syncID) == syncOps.end()) {
         if (syncOps.size() > 1) {
             output->verbose(CALL_INFO, 4, 0, "Registered Sync for syncID = %ld. Sync op size: \n", syncID);
         }
-        auto syncOp = SyncOperation(syncID, syncSize, op);
+        auto syncOp = SyncOperation(syncID, syncSize, bytes, op);
         syncOp.incrementReadyCount(ChipID);
         output->verbose(CALL_INFO, 4, 0, "Registered Sync for syncID = %ld\n", syncID);
         if (recvValue) {
@@ -57,9 +162,14 @@ bool CinnamonNetwork::tryRegisterSync(size_t ChipID, uint64_t syncID, uint64_t s
                 // aggregateDestination = ChipID;
             } else if (op == OpType::Brc) {
                 syncOp.addBroadcastDestination(ChipID);
+            } else if (isExchange(op)) {
+                syncOp.addParticipant(ChipID);
             }
         }
         syncOps[syncID] = std::move(syncOp);
+        if (syncOps.at(syncID).ready()) {
+            markBusy();
+        }
         return true;
     } else {
         auto &syncOp = syncOps.at(syncID);
@@ -69,6 +179,9 @@ bool CinnamonNetwork::tryRegisterSync(size_t ChipID, uint64_t syncID, uint64_t s
         if (syncSize != syncOp.syncSize()) {
             throw std::invalid_argument("Registered syncSize does not match expected syncSize");
         }
+        if (bytes != syncOp.bytes()) {
+            throw std::invalid_argument("Registered payload size does not match expected payload size");
+        }
         syncOp.incrementReadyCount(ChipID);
         if (recvValue) {
             syncOp.incrementInputsPending();
@@ -79,9 +192,14 @@ bool CinnamonNetwork::tryRegisterSync(size_t ChipID, uint64_t syncID, uint64_t s
                 syncOp.setAggregationDestination(ChipID);
             } else if (op == OpType::Brc) {
                 syncOp.addBroadcastDestination(ChipID);
+            } else if (isExchange(op)) {
+                syncOp.addParticipant(ChipID);
             }
         }
         output->verbose(CALL_INFO, 4, 0, "Increment readyCount to %ld for syncID = %ld\n", syncOp.readyCount(), syncID);
+        if (syncOp.ready()) {
+            markBusy();
+        }
         return true;
     }
     return false;
@@ -103,6 +221,8 @@ bool CinnamonNetwork::networkReady(uint64_t syncID) const {
         } else if (operation == OpType::Agg) {
             assert(syncOp.outputsPending() == 1);
             assert(syncOp.aggregationDestination() != -1);
+        } else if (isExchange(operation)) {
+            assert(syncOp.participants().size() == syncOp.syncSize());
         }
         // syncOp.computeRoute();
     }
@@ -117,31 +237,22 @@ void CinnamonNetwork::handleInput(SST::Event *ev, int portID) {
         return;
     }
 
+    receiveInput(syncID, portID);
+    for (auto shadowID : shadowChips[portID]) {
+        receiveInput(syncID, shadowID);
+    }
+}
+
+void CinnamonNetwork::receiveInput(uint64_t syncID, int portID) {
     auto &syncOp = syncOps.at(syncID);
     syncOp.decrementInputsPending();
     assert(syncOp.inputsPending() >= 0);
-    output->verbose(CALL_INFO, 2, 4, "%s: %lu Received Incoming with syncID : %lu\n", getName().c_str(), accelerator->getCurrentSimCycle(), networkEvent->syncID());
-    if (syncOp.inputsPending() == 0) {
-        auto operation = syncOp.operation();
-        if (operation == OpType::Brc) {
-            for (auto &i : syncOp.broadcastDestinations()) {
-                if (i == portID) {
-                    continue;
-                }
-                // TODO: Make buffers here that handle the latency of ops
-                auto outputBWBufferEntry = CinnamonNetworkOutputBWEntry(syncID, 224 * 1024);
-                outputBWBuffer[i].push_back(outputBWBufferEntry);
-            }
-        } else if (operation == OpType::Agg) {
-            auto aggregationDestination = syncOp.aggregationDestination();
-            assert(aggregationDestination != -1);
-
-            auto outputBWBufferEntry = CinnamonNetworkOutputBWEntry(syncID, 224 * 1024);
-            outputBWBuffer[aggregationDestination].push_back(outputBWBufferEntry);
-        } else {
-            throw std::runtime_error("Unimplement Network Operation");
-        }
+    output->verbose(CALL_INFO, 2, 4, "%s: %lu Received Incoming with syncID : %lu\n", getName().c_str(), accelerator->getCurrentSimCycle(), syncID);
+    if (!syncOp.started) {
+        syncOp.started = true;
+        syncOp.startTime = getCurrentSimTime("1ps");
     }
+    routeInput(syncID, portID);
 }
 
 void CinnamonNetwork::handleOutput(SST::Event *ev, int portID) {
@@ -155,19 +266,158 @@ void CinnamonNetwork::handleOutput(SST::Event *ev, int portID) {
     auto &syncOp = syncOps.at(syncID);
 
     output->verbose(CALL_INFO, 4, 0, "%s: %lu Outputing syncID : %lu to chip: %d\n", getName().c_str(), accelerator->getCurrentSimCycle(), networkEvent->syncID(), portID);
-    auto responseEvent = std::make_unique<CinnamonNetworkEvent>(networkEvent->syncID());
-
     auto hops_ = syncOp.computeHops();
+    assert(!outputBWBuffer[portID].empty());
+    auto &bufferEntry = outputBWBuffer[portID].front();
+    assert(bufferEntry.inFlight == true);
+    outputBWBuffer[portID].pop_front();
+    startOutput(portID);
+    // A participant of an exchange has its result once every piece it expects has been output
+    if (isExchange(syncOp.operation()) && !syncOp.receivePiece(portID, getCurrentSimTime("1ps"))) {
+        return;
+    }
     /* -1 because we already counted the latency once while receiving*/
-    chipLinks[portID]->send(hops_ - 1 /*Latency */, responseEvent.release());
+    deliver(syncID, portID, hops_ - 1);
+}
+
+void CinnamonNetwork::deliver(uint64_t syncID, int portID, SimTime_t latency) {
+    auto &syncOp = syncOps.at(syncID);
+    if (!isShadowChip[portID]) {
+        auto responseEvent = std::make_unique<CinnamonNetworkEvent>(syncID);
+        chipLinks[portID]->send(latency, responseEvent.release());
+    }
     syncOp.decrementOutputsPending();
     if (syncOp.inputsPending() == 0 && syncOp.outputsPending() == 0) {
         completeOperation(syncID);
     }
-    assert(!outputBWBuffer[portID].empty());
-    auto &bufferEntry = outputBWBuffer[portID].front();
-    assert(bufferEntry.inFlight == true);
-    outputBWBuffer[portID].pop_front();
+}
+
+void CinnamonNetwork::routeInput(uint64_t syncID, int portID) {
+    auto &syncOp = syncOps.at(syncID);
+    if (!topology) {
+        if (syncOp.inputsPending() == 0) {
+            auto operation = syncOp.operation();
+            if (operation == OpType::Brc) {
+                for (auto &i : syncOp.broadcastDestinations()) {
+                    if (i == portID) {
+                        continue;
+                    }
+                    // TODO: Make buffers here that handle the latency of ops
+                    enqueueOutput(i, CinnamonNetworkOutputBWEntry(syncID, syncOp.bytes()));
+                }
+            } else if (operation == OpType::Agg) {
+                auto aggregationDestination = syncOp.aggregationDestination();
+                assert(aggregationDestination != -1);
+
+                enqueueOutput(aggregationDestination, CinnamonNetworkOutputBWEntry(syncID, syncOp.bytes()));
+            } else if (isExchange(operation)) {
+                // An all-gather outputs the value of every other participant. The shares of a reduce-scatter
+                // or all-to-all are output together
+                int pieces = (operation == OpType::AllGather) ? syncOp.syncSize() - 1 : std::min<int>(syncOp.syncSize() - 1, 1);
+                uint64_t pieceBytes = (operation == OpType::AllGather) ? syncOp.pieceBytes() : (syncOp.syncSize() - 1) * syncOp.pieceBytes();
+                auto participants = syncOp.participants();
+                for (auto &i : participants) {
+                    if (pieces == 0) {
+                        deliver(syncID, i, 0);
+                        continue;
+                    }
+                    syncOp.expectPieces(i, pieces);
+                    for (int p = 0; p < pieces; p++) {
+                        enqueueOutput(i, CinnamonNetworkOutputBWEntry(syncID, pieceBytes));
+                    }
+                }
+            } else {
+                throw std::runtime_error("Unimplement Network Operation");
+            }
+        }
+        return;
+    }
+
+    const SimTime_t now = getCurrentSimTime("1ps");
+    const uint64_t bytes = syncOp.bytes();
+    auto operation = syncOp.operation();
+    auto algorithm = collective->select(syncOp.syncSize());
+    syncOp.inputs.emplace_back(portID, now);
+    if (operation == OpType::Brc) {
+        std::vector<size_t> destinations;
+        for (auto &i : syncOp.broadcastDestinations()) {
+            if (i != portID) {
+                destinations.push_back(i);
+            }
+        }
+        for (auto &[destination, arrival] : collective->broadcast(*topology, algorithm, portID, destinations, bytes, now)) {
+            scheduleDelivery(syncID, destination, arrival);
+        }
+    } else if (operation == OpType::Agg) {
+        // The reduction is scheduled once every partial sum is available
+        auto aggregationDestination = syncOp.aggregationDestination();
+        assert(aggregationDestination != -1);
+        if (syncOp.inputsPending() == 0) {
+            auto complete = inNetworkReduction ? topology->reduceInNetwork(aggregationDestination, syncOp.inputs, bytes, reduceLatency, reducePsPerByte)
+                                               : collective->reduce(*topology, algorithm, aggregationDestination, syncOp.inputs, bytes);
+            scheduleDelivery(syncID, aggregationDestination, std::max(complete, now));
+        }
+    } else if (isExchange(operation)) {
+        routeExchange(syncID, portID);
+    } else {
+        throw std::runtime_error("Unimplement Network Operation");
+    }
+}
+
+void CinnamonNetwork::routeExchange(uint64_t syncID, int portID) {
+    auto &syncOp = syncOps.at(syncID);
+    const SimTime_t now = getCurrentSimTime("1ps");
+    auto operation = syncOp.operation();
+    auto algorithm = collective->select(syncOp.syncSize());
+    const uint64_t pieceBytes = syncOp.pieceBytes();
+
+    if (operation == OpType::ReduceScatter) {
+        // Every share is reduced once all values are available
+        if (syncOp.inputsPending() == 0 && inNetworkReduction) {
+            for (auto &[participant, time] : syncOp.inputs) {
+                auto complete = topology->reduceInNetwork(participant, syncOp.inputs, pieceBytes, reduceLatency, reducePsPerByte);
+                scheduleDelivery(syncID, participant, std::max(complete, now));
+            }
+        } else if (syncOp.inputsPending() == 0) {
+            for (auto &[participant, complete] : collective->reduceScatter(*topology, algorithm, syncOp.inputs, pieceBytes)) {
+                scheduleDelivery(syncID, participant, std::max(complete, now));
+            }
+        }
+        return;
+    }
+
+    std::vector<size_t> destinations;
+    for (auto &i : syncOp.participants()) {
+        if (i != portID) {
+            destinations.push_back(i);
+        }
+    }
+    // Each participant's own piece is available as soon as it has sent it
+    std::vector<std::pair<size_t, SimTime_t>> arrivals{{portID, now}};
+    auto sent = (operation == OpType::AllGather) ? collective->allGather(*topology, algorithm, portID, destinations, pieceBytes, now)
+                                                 : collective->allToAll(*topology, portID, destinations, pieceBytes, now);
+    arrivals.insert(arrivals.end(), sent.begin(), sent.end());
+    for (auto &[destination, arrival] : arrivals) {
+        if (syncOp.receivePiece(destination, arrival)) {
+            scheduleDelivery(syncID, destination, syncOp.lastPiece(destination));
+        }
+    }
+}
+
+SimTime_t CinnamonNetwork::transferTime(uint64_t bytes) const {
+    return std::max<SimTime_t>(static_cast<SimTime_t>(std::ceil(bytes * psPerByte)), 1);
+}
+
+void CinnamonNetwork::scheduleDelivery(uint64_t syncID, int portID, SimTime_t arrival) {
+    const SimTime_t now = getCurrentSimTime("1ps");
+    auto event = std::make_unique<CinnamonNetworkEvent>(syncID);
+    deliveryTiming[portID]->send(arrival - now, event.release());
+}
+
+void CinnamonNetwork::handleDelivery(SST::Event *ev, int portID) {
+    std::unique_ptr<CinnamonNetworkEvent> networkEvent(static_cast<CinnamonNetworkEvent *>(ev));
+    output->verbose(CALL_INFO, 4, 0, "%s: %lu Delivering syncID : %lu to chip: %d\n", getName().c_str(), accelerator->getCurrentSimCycle(), networkEvent->syncID(), portID);
+    deliver(networkEvent->syncID(), portID, 0);
 }
 
 void CinnamonNetwork::completeOperation(uint64_t syncID) {
@@ -175,53 +425,63 @@ void CinnamonNetwork::completeOperation(uint64_t syncID) {
     auto &syncOp = syncOps.at(syncID);
     assert(syncOp.inputsPending() == 0);
     assert(syncOp.outputsPending() == 0);
+    SimTime_t syncTime = getCurrentSimTime("1ps") - syncOp.startTime;
+    stats_.syncsCompleted++;
+    stats_.totalSyncTime += syncTime;
+    stats_.maxSyncTime = std::max(stats_.maxSyncTime, syncTime);
+    markIdle();
     output->verbose(CALL_INFO, 3, 0, "Completed Operation for syncID = %ld\n", syncID);
     syncOps.erase(syncID);
 }
 
-bool CinnamonNetwork::tick(SST::Cycle_t cycle) {
-    for (auto &[k, v] : syncOps) {
-        if (v.ready()) {
-            stats_.busyCycles++;
-            stats_.busyCyclesWindow++;
-            break;
-        }
+void CinnamonNetwork::enqueueOutput(int portID, const CinnamonNetworkOutputBWEntry &entry) {
+    outputBWBuffer[portID].push_back(entry);
+    startOutput(portID);
+}
+
+void CinnamonNetwork::startOutput(int portID) {
+    if (outputBWBuffer[portID].empty()) {
+        return;
     }
+    auto &bufferEntry = outputBWBuffer[portID].front();
+    if (bufferEntry.inFlight) {
+        return; // Started again by handleOutput once the entry in flight has been output
+    }
+    auto packet = std::make_unique<CinnamonNetworkEvent>(bufferEntry.syncID);
+    outputTiming[portID]->send(transferTime(bufferEntry.size), packet.release());
+    bufferEntry.inFlight = true;
+}
 
-    if (cycle % 100000 == 0) {
-        output->verbose(CALL_INFO, 2, 0, "%s:Heartbeat @ %" PRIu64 " 00K cycles. Network Util Cycles: %" PRIu64 "\n", getName().c_str(), cycle / (100000), stats_.busyCyclesWindow);
-        output->flush();
-        stats_.busyCyclesWindow = 0;
+void CinnamonNetwork::markBusy() {
+    if (activeSyncs++ == 0) {
+        busySince = getCurrentSimTime("1ps");
     }
-    stats_.totalCycles++;
-    bufferTick(cycle);
-    return true;
 }
 
-bool CinnamonNetwork::bufferTick(SST::Cycle_t cycle) {
-    for (size_t i = 0; i < numChips; i++) {
-        if (outputBWBuffer[i].empty()) {
-            continue;
-        }
-        auto &bufferEntry = outputBWBuffer[i].front();
-        if (bufferEntry.inFlight) {
-            continue;
-        }
-        auto packet = std::make_unique<CinnamonNetworkEvent>(bufferEntry.syncID);
-        outputTiming[i]->send(1, packet.release());
-        bufferEntry.inFlight = true;
+void CinnamonNetwork::markIdle() {
+    assert(activeSyncs > 0);
+    if (--activeSyncs == 0) {
+        stats_.busyTime += getCurrentSimTime("1ps") - busySince;
     }
-    return true;
 }
 
 std::string CinnamonNetwork::printStats() const {
 
     std::stringstream s;
+    const SimTime_t now = getCurrentSimTime("1ps");
+    const SimTime_t busyTime = stats_.busyTime + (activeSyncs ? now - busySince : 0);
     s << "Network Unit: \n";
-    s << "\tTotal Cycles: " << stats_.totalCycles << "\n";
-    s << "\tBusy Cycles: " << stats_.busyCycles << "\n";
-    double utilisation = ((100.0) * stats_.busyCycles) / stats_.totalCycles;
+    s << "\tElapsed Time (ps): " << now << "\n";
+    s << "\tBusy Time (ps): " << busyTime << "\n";
+    double utilisation = now ? ((100.0) * busyTime) / now : 0.0;
     s << "\tUtilisation %: " << utilisation << "\n";
+    s << "\tSyncs Completed: " << stats_.syncsCompleted << "\n";
+    s << "\tAverage Sync Time (ps): " << (stats_.syncsCompleted ? stats_.totalSyncTime / stats_.syncsCompleted : 0) << "\n";
+    s << "\tMax Sync Time (ps): " << stats_.maxSyncTime << "\n";
+    if (topology) {
+        s << topology->printStats(now);
+        s << collective->printStats();
+    }
     return s.str();
 }
 
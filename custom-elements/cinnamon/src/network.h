@@ -2,6 +2,7 @@
 #ifndef __CINNAMON_NETWORK_H
 #define __CINNAMON_NETWORK_H
 
+#include <algorithm>
 #include <cmath>
 #include <mutex>
 #include <optional>
@@ -9,6 +10,9 @@
 #include <sst/core/params.h>
 #include <sst/core/subcomponent.h>
 
+#include "collective.h"
+#include "topology.h"
+
 namespace SST {
 namespace Cinnamon {
 
@@ -33,18 +37,24 @@ private:
 class CinnamonNetwork : public SubComponent {
 public:
     enum OpType {
-        Brc, // Broadcast
-        Agg  // Aggregate
+        Brc,           // Broadcast
+        Agg,           // Aggregate
+        AllGather,     // Every participant receives the values of all participants
+        ReduceScatter, // Every participant receives its share of the sum of all values
+        AllToAll       // Every participant receives its share of the value of every participant
     };
 
+    // Exchanges have every participant both send a value and receive a result
+    static bool isExchange(OpType op) {
+        return op == OpType::AllGather || op == OpType::ReduceScatter || op == OpType::AllToAll;
+    }
+
     CinnamonNetwork(ComponentId_t id, Params &params, CinnamonAccelerator *accelerator, size_t numChips);
     ~CinnamonNetwork();
 
     void init(unsigned int phase);
     void setup();
     void finish();
-    bool tick(Cycle_t);
-    bool bufferTick(Cycle_t);
 
     SST_ELI_REGISTER_SUBCOMPONENT_API(SST::Cinnamon::CinnamonNetwork, CinnamonAccelerator *, size_t)
 
@@ -56,6 +66,25 @@ public:
         "Cinnamon Network",
         SST::Cinnamon::CinnamonNetwork);
 
+    SST_ELI_DOCUMENT_PARAMS(
+        {"verbose", "Verbosity for debugging. Increased numbers for increased verbosity.", "0"},
+        {"linkBW", "Bandwidth of a network link", "64GB/s"},
+        {"topology", "Network topology: legacy (log2 of the chip span hops with one output channel per chip), ring, torus2d or switch", "legacy"},
+        {"hopLatency", "ring, torus2d and switch: latency of one link", "20ns"},
+        {"torusWidth", "torus2d: number of chips in a row. 0 picks the largest divisor of the chip count that is at most its square root", "0"},
+        {"collectiveAlgorithm", "ring, torus2d and switch: algorithm of broadcasts and aggregations: direct, chain, ring or tree", "direct"},
+        {"collectiveThresholds", "Array of size:algorithm entries. Syncs with at most size chips use algorithm instead of collectiveAlgorithm", "[]"},
+        {"chunkSize", "Bytes a collective forwards at a time. 0 forwards whole values", "0"},
+        {"inNetworkReduction", "ring, torus2d and switch: aggregations and reduce-scatters are combined by the switches and chips along the routes to the destination instead of by collectiveAlgorithm", "false"},
+        {"reduceLatency", "inNetworkReduction: latency of combining partial sums at a node", "10ns"},
+        {"reduceBW", "inNetworkReduction: bytes per second a node combines", "64GB/s"},
+        {"chipsPerBoard", "ring, torus2d and switch: chips on a board. topology, linkBW, hopLatency and torusWidth describe the links within a board and the first chip of every board connects it to the fabric. 0 puts all chips on one board", "0"},
+        {"fabricTopology", "chipsPerBoard: topology connecting the boards: ring, torus2d or switch", "switch"},
+        {"fabricLinkBW", "chipsPerBoard: bandwidth of a link between boards", "25GB/s"},
+        {"fabricHopLatency", "chipsPerBoard: latency of one link between boards", "500ns"},
+        {"fabricTorusWidth", "chipsPerBoard: number of boards in a row of a torus2d fabric. 0 picks the largest divisor of the board count that is at most its square root", "0"},
+        {"hierarchicalCollectives", "chipsPerBoard: run collectives between one representative per board and then within each board, so each value crosses the fabric once per board", "true"}, )
+
     SST_ELI_DOCUMENT_PORTS(
         {"chip_port_%(numChips)d", "Ports which connect to chips.", {}})
     // Attempt to register a synchronisation across chips
@@ -63,18 +92,26 @@ public:
 
     // Returns true if synchronisation registered on the network
     // Note: This call must succeed only once per chip per id
-    bool tryRegisterSync(size_t ChipID, uint64_t id, uint64_t syncSize, OpType op, bool sendReply /* Does the network need to send you a value */, bool recvValue /* Are you sending a value to the network*/);
+    // bytes is the size of the value each chip sends or receives
+    bool tryRegisterSync(size_t ChipID, uint64_t id, uint64_t syncSize, uint64_t bytes, OpType op, bool sendReply /* Does the network need to send you a value */, bool recvValue /* Are you sending a value to the network*/);
 
     // Return true if all chips have reached the synchronisation barrier for a syncID
     bool networkReady(uint64_t id) const;
 
-    std::string printStats() const;
+    // Shadow chips are not simulated; their timing is replayed from a representative chip (symmetry reduction).
+    // The network registers, receives and delivers on their behalf whenever the representative does,
+    // so every sync still accounts for the full chip count
+    void addShadowChip(size_t representativeID, size_t shadowID);
+
+    virtual std::string printStats() const;
 
 private:
     CinnamonNetwork();                        // Serialization only
     CinnamonNetwork(const CinnamonNetwork &); // Do not impl.
     void operator=(const CinnamonNetwork &);  // Do not impl.
 
+protected:
+
     CinnamonAccelerator *accelerator;
     std::shared_ptr<SST::Output> output;
     size_t numChips;
@@ -83,20 +120,46 @@ private:
         uint64_t syncID_;
         size_t readyCount_;
         size_t syncSize_;
+        uint64_t bytes_;
         OpType operation_;
         int inputsPending_;
         int outputsPending_;
         int aggregationDestination_;
         std::vector<int> broadcastDestinations_;
+        // Exchanges: participants, and per participant the pieces still to arrive and the arrival of the latest one
+        std::vector<int> participants_;
+        std::map<int, int> piecesPending_;
+        std::map<int, SimTime_t> lastPiece_;
         int minDestination = 100000;
         int maxDestination = -1;
+        bool started = false;
+        SimTime_t startTime = 0; // Arrival of the first input, in ps
+        // Chips whose input has arrived and its arrival time, in ps
+        std::vector<std::pair<size_t, SimTime_t>> inputs;
 
-        SyncOperation() : syncID_(-1), syncSize_(-1), readyCount_(-1), inputsPending_(-1), outputsPending_(-1), aggregationDestination_(-1) {}
-        SyncOperation(uint64_t syncID, size_t syncSize, OpType operation) : syncID_(syncID), syncSize_(syncSize), readyCount_(0), operation_(operation), inputsPending_(0), outputsPending_(0), aggregationDestination_(-1), minDestination(10000), maxDestination(-1) {}
+        SyncOperation() : syncID_(-1), readyCount_(-1), syncSize_(-1), bytes_(0), inputsPending_(-1), outputsPending_(-1), aggregationDestination_(-1) {}
+        SyncOperation(uint64_t syncID, size_t syncSize, uint64_t bytes, OpType operation) : syncID_(syncID), readyCount_(0), syncSize_(syncSize), bytes_(bytes), operation_(operation), inputsPending_(0), outputsPending_(0), aggregationDestination_(-1), minDestination(10000), maxDestination(-1) {}
 
         void addBroadcastDestination(int dest) {
             broadcastDestinations_.push_back(dest);
         }
+        void addParticipant(int chip) {
+            participants_.push_back(chip);
+            piecesPending_[chip] = syncSize_;
+        }
+        void expectPieces(int chip, int pieces) {
+            piecesPending_.at(chip) = pieces;
+        }
+        // Returns true once the last piece expected by chip has arrived
+        bool receivePiece(int chip, SimTime_t arrival) {
+            auto &pending = piecesPending_.at(chip);
+            assert(pending > 0);
+            lastPiece_[chip] = std::max(lastPiece_[chip], arrival);
+            return --pending == 0;
+        }
+        SimTime_t lastPiece(int chip) const {
+            return lastPiece_.at(chip);
+        }
         void setAggregationDestination(int dest) {
             assert(aggregationDestination_ == -1);
             aggregationDestination_ = dest;
@@ -131,6 +194,10 @@ private:
             return syncSize_;
         }
 
+        auto bytes() const {
+            return bytes_;
+        }
+
         auto readyCount() const {
             return readyCount_;
         }
@@ -155,6 +222,18 @@ private:
             return broadcastDestinations_;
         }
 
+        const auto &participants() const {
+            return participants_;
+        }
+
+        // Bytes a participant sends to each other participant
+        uint64_t pieceBytes() const {
+            if (operation_ == OpType::AllGather) {
+                return bytes_;
+            }
+            return std::max<uint64_t>((bytes_ + syncSize_ - 1) / syncSize_, 1);
+        }
+
         std::size_t computeHops() const {
             return static_cast<std::size_t>(std::log2(maxDestination - minDestination));
         }
@@ -173,22 +252,59 @@ private:
     std::map<uint64_t, SyncOperation> syncOps;
     std::vector<std::deque<CinnamonNetworkOutputBWEntry>> outputBWBuffer;
 
-    int hops;
+    double psPerByte; // Serialisation time of a byte on a link
+    // Time in ps a link takes to serialise bytes
+    SimTime_t transferTime(uint64_t bytes) const;
     mutable std::shared_mutex mtx;
 
     std::vector<Link *> chipLinks;
     std::vector<Link *> outputTiming;
 
+    // Links and routes between chips. Without a topology the legacy model is used
+    std::unique_ptr<CinnamonTopology> topology;
+    std::unique_ptr<CinnamonCollective> collective;
+    // Chips on a board of a hierarchical topology. 0 when all chips are on one board
+    size_t chipsPerBoard = 0;
+    bool inNetworkReduction = false;
+    SimTime_t reduceLatency = 0;
+    double reducePsPerByte = 0;
+    std::vector<Link *> deliveryTiming;
+
+    std::vector<std::vector<size_t>> shadowChips;
+    std::vector<bool> isShadowChip;
+
+    // The network is busy while at least one sync that every chip has reached is in progress
+    size_t activeSyncs = 0;
+    SimTime_t busySince = 0;
+    void markBusy();
+    void markIdle();
+
     struct Stats {
-        SST::Cycle_t totalCycles = 0;
-        SST::Cycle_t busyCycles = 0;
-        SST::Cycle_t busyCyclesWindow = 0;
+        SimTime_t busyTime = 0;
+        uint64_t syncsCompleted = 0;
+        SimTime_t totalSyncTime = 0;
+        SimTime_t maxSyncTime = 0;
     } stats_;
 
     // Mark the operation as complete and make the network ready to accept the next operation
     void completeOperation(uint64_t syncID);
+    bool registerSync(size_t ChipID, uint64_t id, uint64_t syncSize, uint64_t bytes, OpType op, bool sendReply, bool recvValue);
+    void receiveInput(uint64_t syncID, int portID);
     void handleInput(SST::Event *ev, int id);
     void handleOutput(SST::Event *ev, int id);
+    // Legacy model: queues a transfer on the output channel of a chip and starts it if the channel is idle
+    void enqueueOutput(int portID, const CinnamonNetworkOutputBWEntry &entry);
+    void startOutput(int portID);
+    // Sends the result of a sync to a chip and completes the sync once every chip has its result
+    void deliver(uint64_t syncID, int portID, SimTime_t latency);
+
+    // Starts sending an input that arrived at the network to the chips that need it
+    virtual void routeInput(uint64_t syncID, int portID);
+    void routeExchange(uint64_t syncID, int portID);
+
+    // Topology model
+    void scheduleDelivery(uint64_t syncID, int portID, SimTime_t arrival);
+    void handleDelivery(SST::Event *ev, int id);
 };
 } // namespace Cinnamon
 } // namespace SST
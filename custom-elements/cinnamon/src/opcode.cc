@@ -33,6 +33,15 @@ std::string getOpCodeString(CinnamonInstructionOpCode opCode) {
     case OpCode::Joi:
         str = "Joi";
         break;
+    case OpCode::Agt:
+        str = "Agt";
+        break;
+    case OpCode::Rsc:
+        str = "Rsc";
+        break;
+    case OpCode::Ata:
+        str = "Ata";
+        break;
     case OpCode::Add:
         str = "Add";
         break;
@@ -90,6 +99,12 @@ std::string getOpCodeString(CinnamonInstructionOpCode opCode) {
     case OpCode::Mod:
         str = "Mod";
         break;
+    case OpCode::RoiBegin:
+        str = "RoiBegin";
+        break;
+    case OpCode::RoiEnd:
+        str = "RoiEnd";
+        break;
     default:
         throw std::invalid_argument("Invalid OpCode : " + std::to_string((uint32_t)opCode));
     }
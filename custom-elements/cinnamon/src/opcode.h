@@ -17,6 +17,9 @@ enum class CinnamonInstructionOpCode {
     Dis,
     Rcv,
     Joi,
+    Agt,
+    Rsc,
+    Ata,
     Add,
     Sub,
     Neg,
@@ -36,6 +39,8 @@ enum class CinnamonInstructionOpCode {
     Rsi,
     Rsv,
     Mod,
+    RoiBegin,
+    RoiEnd,
     NUM_OPCODES
 };
 
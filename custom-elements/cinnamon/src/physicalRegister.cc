@@ -1,4 +1,5 @@
 // Copyright (c) Siddharth Jayashankar. All rights reserved.
+#include <algorithm>
 #include <cassert>
 #include <optional>
 #include <sstream>
@@ -30,5 +31,22 @@ void PhysicalRegister::addToFreeListIfFree() {
     }
 }
 
+std::optional<std::uint64_t> PhysicalRegister::consumerStart(std::uint64_t readCycles) const {
+    if (valueReady) {
+        return 0;
+    }
+    if (!stream) {
+        return std::nullopt;
+    }
+    auto written = [&](std::uint64_t chunk) {
+        return stream->start + ((chunk + 1) * (stream->end - stream->start) + stream->chunks - 1) / stream->chunks;
+    };
+    // The consumer reads chunk i readCycles * i / chunks cycles after it starts. Writes and reads both advance
+    // linearly, so either the first or the last chunk decides the start
+    const std::uint64_t last = stream->chunks - 1;
+    const std::uint64_t lastRead = last * readCycles / stream->chunks;
+    return std::max(written(0), written(last) > lastRead ? written(last) - lastRead : 0);
+}
+
 } // namespace Cinnamon
 } // namespace SST
\ No newline at end of file
@@ -30,15 +30,43 @@ private:
     // bool mapped;
     std::optional<std::uint16_t> mappedVirtualReg;
     std::int16_t references;
+    // A value written into the register chunk by chunk. Chunk i of chunks is written by cycle start + (i + 1) * (end - start) / chunks
+    struct Stream {
+        std::uint64_t start;
+        std::uint64_t end;
+        std::uint64_t chunks;
+    };
+    std::optional<Stream> stream;
+    // Instructions dispatched to read the value since the register was last mapped. None of them can
+    // complete before the value is ready, so while it is being loaded they are all waiting for it
+    std::uint32_t consumers = 0;
 
     void addToFreeListIfFree();
 
 public:
     PhysicalRegister(CinnamonChip *pe, const PhysicalRegister_t type, const std::uint16_t id) : pe(pe), type(type), id(id), valueReady(false), isFree(true), references(0){};
     PhysicalRegister(const PhysicalRegister_t type, const std::uint16_t id) : pe(nullptr), type(type), id(id), valueReady(false), isFree(true), references(0) { assert(type == PhysicalRegister_t::Forwarding); };
-    void setValueReady(bool b) { valueReady = b; }
+    void setValueReady(bool b) {
+        valueReady = b;
+        stream.reset();
+    }
+    void setStreaming(std::uint64_t start, std::uint64_t end, std::uint64_t chunks) {
+        assert(chunks > 0 && end >= start);
+        stream = Stream{start, end, chunks};
+    }
+    // Earliest cycle a consumer that reads the value in order over readCycles cycles can start without overtaking
+    // the chunks still being written. 0 when the value is ready and empty when it is not being written yet
+    std::optional<std::uint64_t> consumerStart(std::uint64_t readCycles) const;
+    // Cycle the last chunk is written. 0 unless the value is being streamed in
+    std::uint64_t streamEnd() const {
+        return (!valueReady && stream) ? stream->end : 0;
+    }
     bool getValueReady() const { return valueReady; }
+    void addConsumer() { consumers++; }
+    void clearConsumers() { consumers = 0; }
+    std::uint32_t numConsumers() const { return consumers; }
     PhysicalRegisterID_t getID() const { return id; }
+    PhysicalRegister_t getType() const { return type; }
 
     std::int16_t numReferences() const {
         return references;
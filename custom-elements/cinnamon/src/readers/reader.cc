@@ -0,0 +1,74 @@
+// Copyright (c) Siddharth Jayashankar. All rights reserved.
+#include "reader.h"
+
+#include <type_traits>
+
+namespace SST {
+namespace Cinnamon {
+
+// Initialised (bci) and referenced Bcu registers share one name space
+static constexpr std::size_t BcuRegisterKind = std::variant_size_v<CinnamonParsedValueType>;
+
+void CinnamonStructuralHasher::reset() {
+    hash = 0;
+    registers.clear();
+    terms.clear();
+}
+
+std::uint64_t CinnamonStructuralHasher::canonicalRegister(std::size_t kind, std::uint16_t id) {
+    auto key = std::make_pair(kind, id);
+    auto it = registers.find(key);
+    if (it == registers.end()) {
+        it = registers.emplace(key, registers.size()).first;
+    }
+    return it->second;
+}
+
+void CinnamonStructuralHasher::addValue(const CinnamonParsedValueType &value) {
+    Utils::hashCombine(hash, value.index());
+    std::visit([&](const auto &arg) {
+        using T = std::decay_t<decltype(arg)>;
+        if constexpr (std::is_same_v<T, CinnamonParsedVectorReg> || std::is_same_v<T, CinnamonParsedScalarReg>) {
+            Utils::hashCombine(hash, canonicalRegister(value.index(), arg.id));
+            Utils::hashCombine(hash, arg.dead);
+        } else if constexpr (std::is_same_v<T, CinnamonParsedBcuInitReg>) {
+            Utils::hashCombine(hash, canonicalRegister(BcuRegisterKind, arg.bcuId));
+            Utils::hashCombine(hash, arg.numWrites);
+            Utils::hashCombine(hash, arg.numReads);
+        } else if constexpr (std::is_same_v<T, CinnamonParsedBcuReg>) {
+            // Bcu registers are referenced by the id given at initialisation
+            Utils::hashCombine(hash, canonicalRegister(BcuRegisterKind, arg.bcuId));
+            Utils::hashCombine(hash, arg.id.value_or(-1));
+        } else if constexpr (std::is_same_v<T, CinnamonParsedTerm>) {
+            auto it = terms.find(arg.term);
+            if (it == terms.end()) {
+                it = terms.emplace(arg.term, terms.size()).first;
+            }
+            Utils::hashCombine(hash, it->second);
+            Utils::hashCombine(hash, arg.free_from_mem);
+        }
+    },
+               value);
+}
+
+void CinnamonStructuralHasher::add(const CinnamonParsedInstruction &instruction) {
+    Utils::hashCombine(hash, static_cast<int>(instruction.opCode));
+    if (includeLimbIndices) {
+        Utils::hashCombine(hash, instruction.baseIndex);
+    }
+    Utils::hashCombine(hash, instruction.syncID.value_or(-1));
+    Utils::hashCombine(hash, instruction.syncSize.value_or(-1));
+    Utils::hashCombine(hash, instruction.syncBytes.value_or(0));
+    Utils::hashCombine(hash, instruction.rotIndex.value_or(0));
+    Utils::hashCombine(hash, instruction.dests.size());
+    for (auto &dest : instruction.dests) {
+        addValue(dest);
+    }
+    Utils::hashCombine(hash, instruction.srcs.size());
+    for (auto &src : instruction.srcs) {
+        addValue(src);
+    }
+}
+
+} // namespace Cinnamon
+} // namespace SST
@@ -3,7 +3,9 @@
 #define _H_SST_CINNAMON_READER
 
 #include "opcode.h"
+#include "utils/utils.h"
 
+#include <map>
 #include <memory>
 #include <optional>
 #include <variant>
@@ -51,6 +53,7 @@ struct CinnamonParsedInstruction {
     std::uint16_t baseIndex;
     std::optional<std::uint64_t> syncID;
     std::optional<std::uint64_t> syncSize;
+    std::optional<std::uint64_t> syncBytes; // Payload of a network instruction, when the trace gives it
     std::optional<std::int32_t> rotIndex;
     std::vector<CinnamonParsedValueType> srcs;
     std::vector<CinnamonParsedValueType> dests;
@@ -60,6 +63,31 @@ struct CinnamonParsedInstruction {
     CinnamonParsedInstruction(const OpCode opCode, const std::uint16_t baseIndex, std::optional<const std::uint32_t> syncID, std::optional<const std::uint32_t> syncSize, const std::vector<CinnamonParsedValueType> &&dests, const std::vector<CinnamonParsedValueType> &&srcs) : opCode(opCode), syncID(syncID), syncSize(syncSize), baseIndex(baseIndex), dests(dests), srcs(srcs) {}
 };
 
+// Hashes the structure of a sequence of parsed instructions.
+// Registers and terms are replaced by the order in which they first appear, so two sequences that
+// only differ in naming (e.g. the per-chip terms of an SPMD trace) hash identically while their
+// dependence and aliasing structure is still captured.
+class CinnamonStructuralHasher {
+public:
+    CinnamonStructuralHasher(bool includeLimbIndices = true) : includeLimbIndices(includeLimbIndices) {}
+
+    void add(const CinnamonParsedInstruction &instruction);
+    void reset();
+
+    std::uint64_t value() const {
+        return hash;
+    }
+
+private:
+    bool includeLimbIndices;
+    std::uint64_t hash = 0;
+    std::map<std::pair<std::size_t, std::uint16_t>, std::uint64_t> registers;
+    std::map<std::string, std::uint64_t> terms;
+
+    void addValue(const CinnamonParsedValueType &value);
+    std::uint64_t canonicalRegister(std::size_t kind, std::uint16_t id);
+};
+
 class CinnamonTraceReader : public SubComponent {
 
 public:
@@ -72,6 +100,9 @@ public:
     ~CinnamonTraceReader(){};
     virtual std::unique_ptr<CinnamonParsedInstruction> readNextInstruction(uint64_t instrId) = 0;
 
+    // Structural hash of the complete trace (see CinnamonStructuralHasher). Does not disturb the read position
+    virtual std::uint64_t traceFingerprint() = 0;
+
 protected:
 };
 
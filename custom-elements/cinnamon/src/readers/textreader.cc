@@ -149,18 +149,31 @@ std::unique_ptr<CinnamonParsedInstruction> CinnamonTextTraceReader::handle_mod(c
     return nullptr;
 }
 
+std::optional<uint64_t> CinnamonTextTraceReader::parseSyncBytes(const std::smatch &match, const std::string &instruction) {
+    if (match[3].length() == 0) {
+        return std::nullopt;
+    }
+    auto bytes = std::stoull(match[3]);
+    if (bytes == 0) {
+        output->fatal(CALL_INFO, -1, "%s, Fatal: Zero payload size in instruction %s in text reader.\n",
+                      getName().c_str(), instruction.c_str());
+    }
+    return bytes;
+}
+
 std::unique_ptr<CinnamonParsedInstruction> CinnamonTextTraceReader::handle_rcv(const std::string &instruction) {
     std::smatch match;
     std::vector<CinnamonParsedValueType> dests;
     std::vector<CinnamonParsedValueType> srcs;
     if (std::regex_search(instruction.begin(), instruction.end(), match, rcv_regex)) {
 
-        dests.push_back(parseValue(match[3]));
+        dests.push_back(parseValue(match[4]));
         std::optional<uint64_t> syncID = std::stoull(match[1]);
         std::optional<uint64_t> syncSize = std::stoull(match[2]);
         auto baseIndex = -1;
 
         auto cinnamonInstruction = std::make_unique<CinnamonParsedInstruction>(OpCode::Rcv, baseIndex, syncID, syncSize, std::move(dests), std::move(srcs));
+        cinnamonInstruction->syncBytes = parseSyncBytes(match, instruction);
         return std::move(cinnamonInstruction);
     } else {
         output->fatal(CALL_INFO, -1, "%s, Fatal: Invalid instruction %s in text reader.\n",
@@ -176,12 +189,13 @@ std::unique_ptr<CinnamonParsedInstruction> CinnamonTextTraceReader::handle_dis(c
     std::vector<CinnamonParsedValueType> srcs;
     if (std::regex_search(instruction.begin(), instruction.end(), match, dis_regex)) {
 
-        srcs.push_back(parseValue(match[3]));
+        srcs.push_back(parseValue(match[4]));
         std::optional<uint64_t> syncID = std::stoull(match[1]);
         std::optional<uint64_t> syncSize = std::stoull(match[2]);
         auto baseIndex = -1;
 
         auto cinnamonInstruction = std::make_unique<CinnamonParsedInstruction>(OpCode::Dis, baseIndex, syncID, syncSize, std::move(dests), std::move(srcs));
+        cinnamonInstruction->syncBytes = parseSyncBytes(match, instruction);
         return std::move(cinnamonInstruction);
     } else {
         output->fatal(CALL_INFO, -1, "%s, Fatal: Invalid instruction %s in text reader.\n",
@@ -199,16 +213,40 @@ std::unique_ptr<CinnamonParsedInstruction> CinnamonTextTraceReader::handle_joi(c
 
         std::optional<uint64_t> syncID = std::stoull(match[1]);
         std::optional<uint64_t> syncSize = std::stoull(match[2]);
-        if (match[3].length() != 0) {
-            dests.push_back(parseValue(match[3]));
+        if (match[4].length() != 0) {
+            dests.push_back(parseValue(match[4]));
         }
-        auto baseIndex = std::stoi(match[7]);
-        if (match[5].length() != 0) {
-            srcs.push_back(parseValue(match[5]));
+        auto baseIndex = std::stoi(match[8]);
+        if (match[6].length() != 0) {
+            srcs.push_back(parseValue(match[6]));
         }
         // srcs.push_back(parseValue(match[4]));
 
         auto cinnamonInstruction = std::make_unique<CinnamonParsedInstruction>(OpCode::Joi, baseIndex, syncID, syncSize, std::move(dests), std::move(srcs));
+        cinnamonInstruction->syncBytes = parseSyncBytes(match, instruction);
+        return std::move(cinnamonInstruction);
+    } else {
+        output->fatal(CALL_INFO, -1, "%s, Fatal: Invalid instruction %s in text reader.\n",
+                      getName().c_str(), instruction.c_str());
+    }
+
+    return nullptr;
+}
+
+std::unique_ptr<CinnamonParsedInstruction> CinnamonTextTraceReader::handle_exchange(OpCode opCode, const std::string &instruction) {
+    std::smatch match;
+    std::vector<CinnamonParsedValueType> dests;
+    std::vector<CinnamonParsedValueType> srcs;
+    if (std::regex_search(instruction.begin(), instruction.end(), match, exchange_regex)) {
+
+        dests.push_back(parseValue(match[4]));
+        srcs.push_back(parseValue(match[6]));
+        std::optional<uint64_t> syncID = std::stoull(match[1]);
+        std::optional<uint64_t> syncSize = std::stoull(match[2]);
+        auto baseIndex = -1;
+
+        auto cinnamonInstruction = std::make_unique<CinnamonParsedInstruction>(opCode, baseIndex, syncID, syncSize, std::move(dests), std::move(srcs));
+        cinnamonInstruction->syncBytes = parseSyncBytes(match, instruction);
         return std::move(cinnamonInstruction);
     } else {
         output->fatal(CALL_INFO, -1, "%s, Fatal: Invalid instruction %s in text reader.\n",
@@ -221,182 +259,217 @@ std::unique_ptr<CinnamonParsedInstruction> CinnamonTextTraceReader::handle_joi(c
 std::unique_ptr<CinnamonParsedInstruction> CinnamonTextTraceReader::readNextInstruction(uint64_t instrId) {
     std::string line;
     if (getline(traceInputFile, line)) {
-        //   std::cout << line << '\n';
-        size_t pos = std::string::npos;
-        std::string instruction_string = line;
+        return parseInstruction(std::move(line));
+    }
+    return nullptr;
+}
+
+std::uint64_t CinnamonTextTraceReader::traceFingerprint() {
+    std::ifstream traceFile(traceFileName, std::ios::in);
+    if (!traceFile.is_open()) {
+        output->fatal(CALL_INFO, -1, "%s, Fatal: Unable to open file: %s in text reader.\n",
+                      getName().c_str(), traceFileName.c_str());
+    }
+
+    CinnamonStructuralHasher hasher;
+    std::string line;
+    // Skip the header line like the constructor does
+    getline(traceFile, line);
+    while (getline(traceFile, line)) {
+        auto instruction = parseInstruction(std::move(line));
+        hasher.add(*instruction);
+    }
+    return hasher.value();
+}
+
+std::unique_ptr<CinnamonParsedInstruction> CinnamonTextTraceReader::parseInstruction(std::string line) {
+    size_t pos = std::string::npos;
+    std::string instruction_string = line;
+
+    // Region of interest markers take no operands
+    auto marker = line.substr(0, line.find_first_of(" \r"));
+    if (marker == "roi_begin") {
+        return std::make_unique<CinnamonParsedInstruction>(OpCode::RoiBegin, 0, std::vector<CinnamonParsedValueType>{}, std::vector<CinnamonParsedValueType>{});
+    } else if (marker == "roi_end") {
+        return std::make_unique<CinnamonParsedInstruction>(OpCode::RoiEnd, 0, std::vector<CinnamonParsedValueType>{}, std::vector<CinnamonParsedValueType>{});
+    }
+    pos = line.find(" ");
+    assert(pos != std::string::npos);
+    auto op = line.substr(0, pos);
+    line.erase(0, pos + 1);
+    std::optional<std::int32_t> rotIndex;
+    if (op == "rot") {
         pos = line.find(" ");
         assert(pos != std::string::npos);
-        auto op = line.substr(0, pos);
+        rotIndex = std::stoi(line.substr(0, pos));
         line.erase(0, pos + 1);
-        std::optional<std::int32_t> rotIndex;
-        if (op == "rot") {
-            pos = line.find(" ");
-            assert(pos != std::string::npos);
-            rotIndex = std::stoi(line.substr(0, pos));
-            line.erase(0, pos + 1);
-        }
+    }
 
-        if (op == "rsi") {
-            return handle_rsi(line);
-        } else if (op == "rsv") {
-            return handle_rsv(line);
-        } else if (op == "mod") {
-            return handle_mod(line);
-        } else if (op == "rcv") {
-            return handle_rcv(line);
-        } else if (op == "dis") {
-            return handle_dis(line);
-        } else if (op == "joi") {
-            return handle_joi(line);
+    if (op == "rsi") {
+        return handle_rsi(line);
+    } else if (op == "rsv") {
+        return handle_rsv(line);
+    } else if (op == "mod") {
+        return handle_mod(line);
+    } else if (op == "rcv") {
+        return handle_rcv(line);
+    } else if (op == "dis") {
+        return handle_dis(line);
+    } else if (op == "joi") {
+        return handle_joi(line);
+    } else if (op == "agt") {
+        return handle_exchange(OpCode::Agt, line);
+    } else if (op == "rsc") {
+        return handle_exchange(OpCode::Rsc, line);
+    } else if (op == "ata") {
+        return handle_exchange(OpCode::Ata, line);
+    }
+    pos = line.find("|");
+    std::uint32_t baseIndex = -1;
+    if (pos != std::string::npos) {
+        baseIndex = std::stoi(line.substr(pos + 1, std::string::npos));
+        line.erase(pos - 1, std::string::npos);
+    }
+    pos = line.find(":");
+    assert(pos != std::string::npos);
+    auto dests_str = line.substr(0, pos);
+    line.erase(0, pos + 2);
+
+    OpCode opCode = OpCode::NUM_OPCODES;
+    std::vector<CinnamonParsedValueType> dests, srcs;
+
+    if (op == "bci") {
+        opCode = OpCode::Bci;
+        dests_str[0] = '0';
+        // auto dest = CinnamonParsedVectorReg(std::stoi(dests_str));
+        std::size_t lBracePos, rBracePos;
+        lBracePos = line.find("[");
+        rBracePos = line.find("]");
+        std::string outBases = line.substr(lBracePos + 1, rBracePos - 1);
+        line = line.erase(0, rBracePos + 1);
+        lBracePos = line.find("[");
+        rBracePos = line.find("]");
+        std::string inBases = line.substr(lBracePos + 1, rBracePos - 1);
+        std::uint8_t numInBases = 0, numOutBases = 0;
+        std::size_t pos;
+        while ((pos = outBases.find(",")) != std::string::npos) {
+            outBases.erase(0, pos + 2);
+            numOutBases++;
+        }
+        numOutBases++;
+        while ((pos = inBases.find(",")) != std::string::npos) {
+            inBases.erase(0, pos + 2);
+            numInBases++;
         }
-        pos = line.find("|");
-        std::uint32_t baseIndex = -1;
+        numInBases++;
+        CinnamonParsedBcuInitReg bcuInitReg(std::stoi(dests_str), numInBases, numOutBases);
+        dests = {bcuInitReg};
+        return std::make_unique<CinnamonParsedInstruction>(opCode, rotIndex, baseIndex, std::move(dests), std::move(srcs));
+    }
+    std::string srcs_str = std::move(line);
+    if (op == "load" || op == "loas" || op == "store" || op == "evg" || op == "spill") {
+        if (op == "load") {
+            opCode = OpCode::LoadV;
+        } else if (op == "loas") {
+            opCode = OpCode::LoadS;
+        } else if (op == "store") {
+            opCode = OpCode::Store;
+        } else if (op == "spill") {
+            opCode = OpCode::Spill;
+        } else if (op == "evg") {
+            opCode = OpCode::EvkGen;
+        } else {
+            assert(0 && "unreachable");
+        }
+        auto pos = dests_str.find(",");
         if (pos != std::string::npos) {
-            baseIndex = std::stoi(line.substr(pos + 1, std::string::npos));
-            line.erase(pos - 1, std::string::npos);
+            output->fatal(CALL_INFO, -1, "%s, Fatal: Invalid instruction %s in text reader.\n",
+                          getName().c_str(), instruction_string.c_str());
         }
-        pos = line.find(":");
-        assert(pos != std::string::npos);
-        auto dests_str = line.substr(0, pos);
-        line.erase(0, pos + 2);
-
-        OpCode opCode = OpCode::NUM_OPCODES;
-        std::vector<CinnamonParsedValueType> dests, srcs;
-
-        if (op == "bci") {
-            opCode = OpCode::Bci;
-            dests_str[0] = '0';
-            // auto dest = CinnamonParsedVectorReg(std::stoi(dests_str));
-            std::size_t lBracePos, rBracePos;
-            lBracePos = line.find("[");
-            rBracePos = line.find("]");
-            std::string outBases = line.substr(lBracePos + 1, rBracePos - 1);
-            line = line.erase(0, rBracePos + 1);
-            lBracePos = line.find("[");
-            rBracePos = line.find("]");
-            std::string inBases = line.substr(lBracePos + 1, rBracePos - 1);
-            std::uint8_t numInBases = 0, numOutBases = 0;
-            std::size_t pos;
-            while ((pos = outBases.find(",")) != std::string::npos) {
-                outBases.erase(0, pos + 2);
-                numOutBases++;
-            }
-            numOutBases++;
-            while ((pos = inBases.find(",")) != std::string::npos) {
-                inBases.erase(0, pos + 2);
-                numInBases++;
-            }
-            numInBases++;
-            CinnamonParsedBcuInitReg bcuInitReg(std::stoi(dests_str), numInBases, numOutBases);
-            dests = {bcuInitReg};
-            return std::make_unique<CinnamonParsedInstruction>(opCode, rotIndex, baseIndex, std::move(dests), std::move(srcs));
+        pos = srcs_str.find(",");
+        if (pos != std::string::npos) {
+            output->fatal(CALL_INFO, -1, "%s, Fatal: Invalid instruction %s in text reader.\n",
+                          getName().c_str(), instruction_string.c_str());
         }
-        std::string srcs_str = std::move(line);
-        if (op == "load" || op == "loas" || op == "store" || op == "evg" || op == "spill") {
-            if (op == "load") {
-                opCode = OpCode::LoadV;
-            } else if (op == "loas") {
-                opCode = OpCode::LoadS;
-            } else if (op == "store") {
-                opCode = OpCode::Store;
-            } else if (op == "spill") {
-                opCode = OpCode::Spill;
-            } else if (op == "evg") {
-                opCode = OpCode::EvkGen;
-            } else {
-                assert(0 && "unreachable");
-            }
-            auto pos = dests_str.find(",");
-            if (pos != std::string::npos) {
+        if (opCode == OpCode::LoadS) {
+            if (dests_str.at(0) != 's') {
                 output->fatal(CALL_INFO, -1, "%s, Fatal: Invalid instruction %s in text reader.\n",
                               getName().c_str(), instruction_string.c_str());
             }
-            pos = srcs_str.find(",");
-            if (pos != std::string::npos) {
+            if (srcs_str.at(0) != 's') {
                 output->fatal(CALL_INFO, -1, "%s, Fatal: Invalid instruction %s in text reader.\n",
                               getName().c_str(), instruction_string.c_str());
             }
-            if (opCode == OpCode::LoadS) {
-                if (dests_str.at(0) != 's') {
-                    output->fatal(CALL_INFO, -1, "%s, Fatal: Invalid instruction %s in text reader.\n",
-                                  getName().c_str(), instruction_string.c_str());
-                }
-                if (srcs_str.at(0) != 's') {
-                    output->fatal(CALL_INFO, -1, "%s, Fatal: Invalid instruction %s in text reader.\n",
-                                  getName().c_str(), instruction_string.c_str());
-                }
-            } else {
-                if (dests_str.at(0) != 'r') {
-                    output->fatal(CALL_INFO, -1, "%s, Fatal: Invalid instruction %s in text reader.\n",
-                                  getName().c_str(), instruction_string.c_str());
-                }
-            }
-            // dests_str[0] = '0';
-            // auto dest = CinnamonParsedVectorReg(std::stoi(dests_str),false);
-            auto dest = parseValue(std::move(dests_str));
-            dests = {dest};
-            pos = srcs_str.find("{F}");
-            bool free_from_mem = false;
-            if (pos != std::string::npos) {
-                srcs_str = srcs_str.substr(0, pos);
-                free_from_mem = true;
-            }
-            auto src = CinnamonParsedTerm(std::move(srcs_str), free_from_mem);
-            srcs = {src};
         } else {
-            if (op == "add") {
-                opCode = OpCode::Add;
-            } else if (op == "ads") {
-                opCode = OpCode::Add;
-            } else if (op == "sub") {
-                opCode = OpCode::Sub;
-            } else if (op == "sus") {
-                opCode = OpCode::Sub;
-            } else if (op == "neg") {
-                opCode = OpCode::Neg;
-            } else if (op == "mul") {
-                opCode = OpCode::Mul;
-            } else if (op == "mup") {
-                opCode = OpCode::Mul;
-            } else if (op == "mus") {
-                opCode = OpCode::Mul;
-            } else if (op == "int") {
-                opCode = OpCode::Int;
-            } else if (op == "ntt") {
-                opCode = OpCode::Ntt;
-            } else if (op == "sud") {
-                opCode = OpCode::SuD;
-            } else if (op == "bcw") {
-                opCode = OpCode::BcW;
-            } else if (op == "pl1") {
-                opCode = OpCode::Pl1;
-            } else if (op == "rot") {
-                opCode = OpCode::Rot;
-            } else if (op == "mov") {
-                opCode = OpCode::Mov;
-            } else if (op == "con") {
-                opCode = OpCode::Con;
-            } else {
-                throw std::invalid_argument("Invalid opCode Parse: " + op);
+            if (dests_str.at(0) != 'r') {
+                output->fatal(CALL_INFO, -1, "%s, Fatal: Invalid instruction %s in text reader.\n",
+                              getName().c_str(), instruction_string.c_str());
             }
+        }
+        // dests_str[0] = '0';
+        // auto dest = CinnamonParsedVectorReg(std::stoi(dests_str),false);
+        auto dest = parseValue(std::move(dests_str));
+        dests = {dest};
+        pos = srcs_str.find("{F}");
+        bool free_from_mem = false;
+        if (pos != std::string::npos) {
+            srcs_str = srcs_str.substr(0, pos);
+            free_from_mem = true;
+        }
+        auto src = CinnamonParsedTerm(std::move(srcs_str), free_from_mem);
+        srcs = {src};
+    } else {
+        if (op == "add") {
+            opCode = OpCode::Add;
+        } else if (op == "ads") {
+            opCode = OpCode::Add;
+        } else if (op == "sub") {
+            opCode = OpCode::Sub;
+        } else if (op == "sus") {
+            opCode = OpCode::Sub;
+        } else if (op == "neg") {
+            opCode = OpCode::Neg;
+        } else if (op == "mul") {
+            opCode = OpCode::Mul;
+        } else if (op == "mup") {
+            opCode = OpCode::Mul;
+        } else if (op == "mus") {
+            opCode = OpCode::Mul;
+        } else if (op == "int") {
+            opCode = OpCode::Int;
+        } else if (op == "ntt") {
+            opCode = OpCode::Ntt;
+        } else if (op == "sud") {
+            opCode = OpCode::SuD;
+        } else if (op == "bcw") {
+            opCode = OpCode::BcW;
+        } else if (op == "pl1") {
+            opCode = OpCode::Pl1;
+        } else if (op == "rot") {
+            opCode = OpCode::Rot;
+        } else if (op == "mov") {
+            opCode = OpCode::Mov;
+        } else if (op == "con") {
+            opCode = OpCode::Con;
+        } else {
+            throw std::invalid_argument("Invalid opCode Parse: " + op);
+        }
 
-            while ((pos = dests_str.find(",")) != std::string::npos) {
-                dests.push_back(parseValue(dests_str.substr(0, pos)));
-                dests_str.erase(0, pos + 2);
-            }
+        while ((pos = dests_str.find(",")) != std::string::npos) {
             dests.push_back(parseValue(dests_str.substr(0, pos)));
-            while ((pos = srcs_str.find(",")) != std::string::npos) {
-                srcs.push_back(parseValue(srcs_str.substr(0, pos)));
-                srcs_str.erase(0, pos + 2);
-            }
+            dests_str.erase(0, pos + 2);
+        }
+        dests.push_back(parseValue(dests_str.substr(0, pos)));
+        while ((pos = srcs_str.find(",")) != std::string::npos) {
             srcs.push_back(parseValue(srcs_str.substr(0, pos)));
+            srcs_str.erase(0, pos + 2);
         }
+        srcs.push_back(parseValue(srcs_str.substr(0, pos)));
+    }
 
-        auto instruction = std::make_unique<CinnamonParsedInstruction>(opCode, rotIndex, baseIndex, std::move(dests), std::move(srcs));
+    auto instruction = std::make_unique<CinnamonParsedInstruction>(opCode, rotIndex, baseIndex, std::move(dests), std::move(srcs));
 
-        return instruction;
-    }
-    return nullptr;
+    return instruction;
 }
 
 } // namespace Cinnamon
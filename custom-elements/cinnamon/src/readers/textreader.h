@@ -17,6 +17,7 @@ public:
     CinnamonTextTraceReader(ComponentId_t id, Params &params, std::shared_ptr<SST::Output> out);
     ~CinnamonTextTraceReader();
     virtual std::unique_ptr<CinnamonParsedInstruction> readNextInstruction(uint64_t instrId) override;
+    virtual std::uint64_t traceFingerprint() override;
 
     SST_ELI_REGISTER_SUBCOMPONENT(
         CinnamonTextTraceReader,
@@ -34,18 +35,25 @@ private:
     std::string traceFileName;
     std::ifstream traceInputFile;
     std::shared_ptr<SST::Output> output;
+    std::unique_ptr<CinnamonParsedInstruction> parseInstruction(std::string line);
     std::regex rsi_regex = std::regex("\\{(r[0-9]+, )*(r[0-9]+)\\}");
     std::unique_ptr<CinnamonParsedInstruction> handle_rsi(const std::string &instruction);
     std::regex rsv_regex = std::regex("\\{(.*)}: (r[0-9]+(\\[X\\])?): \\[(.*)\\] \\| ([0-9]+)");
     std::unique_ptr<CinnamonParsedInstruction> handle_rsv(const std::string &instruction);
     std::regex mod_regex = std::regex("(r[0-9]+(\\[X\\])?): \\{(.*)} \\| ([0-9]+)");
     std::unique_ptr<CinnamonParsedInstruction> handle_mod(const std::string &instruction);
-    std::regex rcv_regex = std::regex("@ ([0-9]+):([0-9]+) (r[0-9]+(\\[X\\])?):");
+    // Network instructions are "@ syncID:syncSize[:payloadBytes] ..."
+    // The optional payload size follows the sync size and must be non-zero
+    std::optional<uint64_t> parseSyncBytes(const std::smatch &match, const std::string &instruction);
+    std::regex rcv_regex = std::regex("@ ([0-9]+):([0-9]+)(?::([0-9]+))? ([rs][0-9]+(\\[X\\])?):");
     std::unique_ptr<CinnamonParsedInstruction> handle_rcv(const std::string &instruction);
-    std::regex dis_regex = std::regex("@ ([0-9]+):([0-9]+) : (r[0-9]+(\\[X\\])?)");
+    std::regex dis_regex = std::regex("@ ([0-9]+):([0-9]+)(?::([0-9]+))? : ([rs][0-9]+(\\[X\\])?)");
     std::unique_ptr<CinnamonParsedInstruction> handle_dis(const std::string &instruction);
-    std::regex joi_regex = std::regex("@ ([0-9]+):([0-9]+) (r[0-9]+(\\[X\\])?)?: (r[0-9]+(\\[X\\])?)? \\| ([0-9]+)");
+    std::regex joi_regex = std::regex("@ ([0-9]+):([0-9]+)(?::([0-9]+))? ([rs][0-9]+(\\[X\\])?)?: ([rs][0-9]+(\\[X\\])?)? \\| ([0-9]+)");
     std::unique_ptr<CinnamonParsedInstruction> handle_joi(const std::string &instruction);
+    // All-gather, reduce-scatter and all-to-all: every participant sends its source and receives its destination
+    std::regex exchange_regex = std::regex("@ ([0-9]+):([0-9]+)(?::([0-9]+))? ([rs][0-9]+(\\[X\\])?): ([rs][0-9]+(\\[X\\])?)");
+    std::unique_ptr<CinnamonParsedInstruction> handle_exchange(OpCode opCode, const std::string &instruction);
 };
 
 CinnamonParsedValueType parseValue(std::string &&value_str);
@@ -0,0 +1,129 @@
+// Copyright (c) Siddharth Jayashankar. All rights reserved.
+#include "sampling.h"
+
+#include <cassert>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+namespace SST {
+namespace Cinnamon {
+
+CinnamonSamplingController::CinnamonSamplingController(uint64_t detailedLength, uint64_t fastForwardLength, uint64_t warmupLength, double targetError, double z, const std::vector<std::string> &unitNames) : detailedLength(detailedLength), fastForwardLength(fastForwardLength), warmupLength(warmupLength), targetError(targetError), z(z), unitNames(unitNames), utilisation(unitNames.size()) {
+    if (detailedLength == 0) {
+        throw std::invalid_argument("Sampling detailed length must be non-zero");
+    }
+    if (targetError <= 0.0 || z <= 0.0) {
+        throw std::invalid_argument("Sampling target error and confidence must be positive");
+    }
+    if (warmupLength == 0) {
+        phase = Phase::Detailed;
+    }
+}
+
+uint64_t CinnamonSamplingController::phaseLength() const {
+    switch (phase) {
+    case Phase::Warmup:
+        return warmupLength;
+    case Phase::Detailed:
+        return detailedLength;
+    case Phase::FastForward:
+        return fastForwardLength;
+    }
+    return 0;
+}
+
+bool CinnamonSamplingController::dispatched() {
+    phaseInstructions++;
+    totalInstructions++;
+    return phaseInstructions >= phaseLength();
+}
+
+void CinnamonSamplingController::advance(const CinnamonActivitySnapshot &now) {
+    switch (phase) {
+    case Phase::Warmup:
+        phase = Phase::Detailed;
+        break;
+    case Phase::Detailed: {
+        auto delta = now - unitStart;
+        cpi.push_back(double(delta.cycle) / phaseInstructions);
+        for (size_t i = 0; i < utilisation.size(); i++) {
+            utilisation[i].push_back(delta.cycle ? double(delta.fuBusyCycles[i]) / delta.cycle : 0.0);
+        }
+        memoryUtilisation.push_back(delta.cycle ? double(delta.memoryBusyCycles) / delta.cycle : 0.0);
+        phase = fastForwardLength ? Phase::FastForward : (warmupLength ? Phase::Warmup : Phase::Detailed);
+        break;
+    }
+    case Phase::FastForward:
+        phase = warmupLength ? Phase::Warmup : Phase::Detailed;
+        break;
+    }
+    phaseInstructions = 0;
+    if (phase == Phase::Detailed) {
+        unitStart = now;
+    }
+}
+
+CinnamonSamplingController::Estimate CinnamonSamplingController::estimate(const std::vector<double> &samples) const {
+    Estimate e;
+    if (samples.empty()) {
+        return e;
+    }
+    double sum = 0.0;
+    for (auto val : samples) {
+        sum += val;
+    }
+    e.mean = sum / samples.size();
+    if (samples.size() > 1) {
+        double squares = 0.0;
+        for (auto val : samples) {
+            squares += (val - e.mean) * (val - e.mean);
+        }
+        e.stdDev = std::sqrt(squares / (samples.size() - 1));
+        e.halfWidth = z * e.stdDev / std::sqrt(double(samples.size()));
+    }
+    return e;
+}
+
+std::string CinnamonSamplingController::printStats() const {
+    std::stringstream s;
+    s << "Sampled Simulation\n";
+    s << "\tDetailed / Warmup / Fast-Forward Lengths: " << detailedLength << " / " << warmupLength << " / " << fastForwardLength << "\n";
+    s << "\tInstructions: " << totalInstructions << "\n";
+    s << "\tSampling Units: " << cpi.size() << "\n";
+    if (cpi.size() < 2) {
+        s << "\tToo few sampling units for an estimate\n";
+        return s.str();
+    }
+
+    auto cpiEstimate = estimate(cpi);
+    double cycles = cpiEstimate.mean * totalInstructions;
+    double cyclesHalfWidth = cpiEstimate.halfWidth * totalInstructions;
+    double relativeError = cpiEstimate.mean ? cpiEstimate.halfWidth / cpiEstimate.mean : 0.0;
+    s << "\tConfidence z: " << z << "\n";
+    s << "\tCycles Per Instruction: " << cpiEstimate.mean << " +/- " << cpiEstimate.halfWidth << "\n";
+    s << "\tEstimated Total Cycles: " << uint64_t(cycles) << " +/- " << uint64_t(cyclesHalfWidth) << "\n";
+    s << "\tAchieved Relative Error %: " << 100.0 * relativeError << "\n";
+    s << "\tTarget Relative Error %: " << 100.0 * targetError << "\n";
+
+    // Sampling units needed for the target error given the observed variation
+    double cv = cpiEstimate.mean ? cpiEstimate.stdDev / cpiEstimate.mean : 0.0;
+    uint64_t required = uint64_t(std::ceil((z * cv / targetError) * (z * cv / targetError)));
+    s << "\tRequired Sampling Units: " << required << "\n";
+    if (required > cpi.size()) {
+        uint64_t period = totalInstructions / required;
+        uint64_t fastForward = period > detailedLength + warmupLength ? period - detailedLength - warmupLength : 0;
+        s << "\tTarget error not met. Suggested fast-forward length: " << fastForward << "\n";
+    }
+
+    auto memory = estimate(memoryUtilisation);
+    s << "\tMemory Utilisation %: " << 100.0 * memory.mean << " +/- " << 100.0 * memory.halfWidth << "\n";
+    for (size_t i = 0; i < unitNames.size(); i++) {
+        auto util = estimate(utilisation[i]);
+        s << "\t" << unitNames[i] << " Utilisation %: " << 100.0 * util.mean << " +/- " << 100.0 * util.halfWidth << "\n";
+    }
+    return s.str();
+}
+
+} // Namespace Cinnamon
+} // Namespace SST
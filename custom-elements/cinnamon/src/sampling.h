@@ -0,0 +1,80 @@
+// Copyright (c) Siddharth Jayashankar. All rights reserved.
+#ifndef _H_SST_CINNAMON_SAMPLING
+#define _H_SST_CINNAMON_SAMPLING
+
+#include <string>
+#include <vector>
+
+#include "memoizer.h"
+
+namespace SST {
+namespace Cinnamon {
+
+// Systematic sampling in the style of SMARTS.
+// The trace is divided into periods of fast-forward, warmup and detailed instructions. Only the detailed
+// units are measured. Total cycles and utilisation are extrapolated from the sampled units together
+// with confidence intervals
+class CinnamonSamplingController {
+public:
+    enum class Phase {
+        Warmup,
+        Detailed,
+        FastForward
+    };
+
+    CinnamonSamplingController(uint64_t detailedLength, uint64_t fastForwardLength, uint64_t warmupLength, double targetError, double z, const std::vector<std::string> &unitNames);
+
+    bool fastForwarding() const {
+        return phase == Phase::FastForward;
+    }
+
+    // Instructions left in the current phase
+    uint64_t remaining() const {
+        return phaseLength() - phaseInstructions;
+    }
+
+    // Starts sampling. now is the activity of the chip before the first instruction
+    void begin(const CinnamonActivitySnapshot &now) {
+        unitStart = now;
+    }
+
+    // Counts a dispatched instruction. Returns true when the current phase is complete
+    bool dispatched();
+
+    // Moves to the next phase. now is the activity of the chip at the phase boundary
+    void advance(const CinnamonActivitySnapshot &now);
+
+    std::string printStats() const;
+
+private:
+    uint64_t detailedLength;
+    uint64_t fastForwardLength;
+    uint64_t warmupLength;
+    double targetError;
+    double z;
+    std::vector<std::string> unitNames;
+
+    Phase phase = Phase::Warmup;
+    uint64_t phaseInstructions = 0;
+    uint64_t totalInstructions = 0;
+    CinnamonActivitySnapshot unitStart;
+
+    // Per sampling unit measurements
+    std::vector<double> cpi;
+    std::vector<std::vector<double>> utilisation;
+    std::vector<double> memoryUtilisation;
+
+    uint64_t phaseLength() const;
+
+    struct Estimate {
+        double mean = 0.0;
+        double halfWidth = 0.0;
+        double stdDev = 0.0;
+    };
+    Estimate estimate(const std::vector<double> &samples) const;
+};
+
+} // Namespace Cinnamon
+} // Namespace SST
+
+#endif
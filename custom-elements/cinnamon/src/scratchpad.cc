@@ -0,0 +1,129 @@
+// Copyright (c) Siddharth Jayashankar. All rights reserved.
+#include "scratchpad.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+
+namespace SST {
+namespace Cinnamon {
+
+CinnamonScratchpad::Policy CinnamonScratchpad::parsePolicy(const std::string &policy) {
+    if (policy == "lru") {
+        return Policy::LRU;
+    }
+    if (policy == "lfu") {
+        return Policy::LFU;
+    }
+    if (policy == "belady") {
+        return Policy::Belady;
+    }
+    throw std::invalid_argument("Unknown scratchpad policy " + policy + ". Expected lru, lfu or belady");
+}
+
+CinnamonScratchpad::CinnamonScratchpad(size_t capacity, size_t banks, size_t limbSize, size_t bankWidth, Policy policy) : capacity(capacity), limbSize(limbSize), policy_(policy), bankBusyUntil(banks, 0) {
+    if (capacity == 0 || banks == 0 || limbSize == 0 || bankWidth == 0) {
+        throw std::invalid_argument("Scratchpad capacity, banks and bank width must be non-zero");
+    }
+    accessCycles = (limbSize + bankWidth - 1) / bankWidth;
+}
+
+std::optional<CinnamonScratchpad::Hit> CinnamonScratchpad::read(Addr addr, SST::Cycle_t currentCycle) {
+    stats_.reads++;
+    accesses++;
+    auto it = entries.find(addr);
+    if (it == entries.end()) {
+        return std::nullopt;
+    }
+    auto &entry = it->second;
+    entry.lastUse = accesses;
+    entry.uses++;
+    stats_.hits++;
+    if (entry.fill && entry.fill->isCompleted()) {
+        entry.fill = nullptr;
+    }
+    if (entry.fill) {
+        stats_.hitsOnFill++;
+    }
+
+    auto &busyUntil = bankBusyUntil[bank(addr)];
+    SST::Cycle_t start = std::max(currentCycle, busyUntil);
+    stats_.bankConflictCycles += start - currentCycle;
+    busyUntil = start + accessCycles;
+    return Hit{busyUntil, entry.fill};
+}
+
+void CinnamonScratchpad::allocate(const std::shared_ptr<CinnamonMemoryInstruction> &fill, const NextUse &nextUse) {
+    Addr addr = fill->getAddr();
+    assert(entries.find(addr) == entries.end());
+    if (entries.size() >= capacity) {
+        auto victim = entries.end();
+        size_t victimNextUse = 0;
+        for (auto it = entries.begin(); it != entries.end(); it++) {
+            switch (policy_) {
+            case Policy::LRU:
+                if (victim == entries.end() || it->second.lastUse < victim->second.lastUse) {
+                    victim = it;
+                }
+                break;
+            case Policy::LFU:
+                if (victim == entries.end() || it->second.uses < victim->second.uses ||
+                    (it->second.uses == victim->second.uses && it->second.lastUse < victim->second.lastUse)) {
+                    victim = it;
+                }
+                break;
+            case Policy::Belady: {
+                size_t distance = nextUse(it->first);
+                if (victim == entries.end() || distance > victimNextUse) {
+                    victim = it;
+                    victimNextUse = distance;
+                }
+                break;
+            }
+            }
+        }
+        if (policy_ == Policy::Belady && nextUse(addr) >= victimNextUse) {
+            stats_.bypasses++;
+            return;
+        }
+        entries.erase(victim);
+        stats_.evictions++;
+    }
+    Entry entry;
+    entry.lastUse = accesses;
+    entry.fill = fill;
+    entries[addr] = entry;
+    stats_.allocations++;
+}
+
+void CinnamonScratchpad::invalidate(Addr addr) {
+    if (entries.erase(addr)) {
+        stats_.invalidations++;
+    }
+}
+
+std::string CinnamonScratchpad::printStats(const std::string &title) const {
+    static const char *policyNames[] = {"LRU", "LFU", "Belady"};
+    std::stringstream s;
+    s << title << "\n";
+    s << "\tCapacity (entries): " << capacity << "\n";
+    s << "\tBanks: " << bankBusyUntil.size() << "\n";
+    s << "\tPolicy: " << policyNames[static_cast<int>(policy_)] << "\n";
+    s << "\tReads: " << stats_.reads << "\n";
+    s << "\tHits: " << stats_.hits << "\n";
+    s << "\tHits While Filling: " << stats_.hitsOnFill << "\n";
+    double hitRate = stats_.reads ? (100.0 * stats_.hits) / stats_.reads : 0.0;
+    s << "\tHit Rate %: " << hitRate << "\n";
+    s << "\tBytes Saved: " << stats_.hits * limbSize << "\n";
+    s << "\tAllocations: " << stats_.allocations << "\n";
+    s << "\tBypasses: " << stats_.bypasses << "\n";
+    s << "\tEvictions: " << stats_.evictions << "\n";
+    s << "\tInvalidations: " << stats_.invalidations << "\n";
+    s << "\tBank Conflict Cycles: " << stats_.bankConflictCycles << "\n";
+    return s.str();
+}
+
+} // namespace Cinnamon
+} // namespace SST
@@ -0,0 +1,100 @@
+// Copyright (c) Siddharth Jayashankar. All rights reserved.
+#ifndef _H_SST_CINNAMON_SCRATCHPAD
+#define _H_SST_CINNAMON_SCRATCHPAD
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "instruction.h"
+#include "sst/core/interfaces/stdMem.h"
+#include "sst/core/sst_types.h"
+
+namespace SST {
+namespace Cinnamon {
+
+// On-chip store of whole limbs that loads are served from instead of HBM.
+// A limb is allocated when a load of it misses and can be read once that load completes.
+// Stores and spills write around the scratchpad and invalidate the limb they overwrite.
+// The scratchpad is split into banks by limb address. Each bank streams one limb at a time.
+// The chip also uses a single bank instance with scalar sized entries as its scalar cache
+class CinnamonScratchpad {
+public:
+    using Addr = Interfaces::StandardMem::Addr;
+
+    enum class Policy {
+        LRU,
+        LFU,
+        Belady // Evicts the limb whose next load is furthest ahead in the trace
+    };
+    static Policy parsePolicy(const std::string &policy);
+
+    // Distance in instructions to the next load of a limb. SIZE_MAX if it is not loaded again
+    using NextUse = std::function<size_t(Addr)>;
+
+    struct Hit {
+        SST::Cycle_t readyCycle;
+        // Load that is filling the limb. The read also waits for it to complete
+        std::shared_ptr<CinnamonMemoryInstruction> fill;
+    };
+
+    CinnamonScratchpad(size_t capacity, size_t banks, size_t limbSize, size_t bankWidth, Policy policy);
+
+    Policy policy() const {
+        return policy_;
+    }
+
+    bool contains(Addr addr) const {
+        return entries.find(addr) != entries.end();
+    }
+
+    // Looks up a load of addr issued at currentCycle
+    std::optional<Hit> read(Addr addr, SST::Cycle_t currentCycle);
+
+    // Allocates the limb loaded by fill after a miss, evicting a victim when the scratchpad is full.
+    // nextUse is only consulted by the Belady policy, which does not allocate a limb that is
+    // loaded again later than every resident limb
+    void allocate(const std::shared_ptr<CinnamonMemoryInstruction> &fill, const NextUse &nextUse);
+
+    void invalidate(Addr addr);
+
+    std::string printStats(const std::string &title) const;
+
+private:
+    struct Entry {
+        uint64_t lastUse = 0;
+        uint64_t uses = 0;
+        std::shared_ptr<CinnamonMemoryInstruction> fill;
+    };
+
+    size_t capacity;
+    size_t limbSize;
+    SST::Cycle_t accessCycles; // Cycles a bank takes to stream one limb
+    Policy policy_;
+    std::unordered_map<Addr, Entry> entries;
+    std::vector<SST::Cycle_t> bankBusyUntil;
+    uint64_t accesses = 0;
+
+    size_t bank(Addr addr) const {
+        return (addr / limbSize) % bankBusyUntil.size();
+    }
+
+    struct Stats {
+        uint64_t reads = 0;
+        uint64_t hits = 0;
+        uint64_t hitsOnFill = 0;
+        uint64_t allocations = 0;
+        uint64_t bypasses = 0;
+        uint64_t evictions = 0;
+        uint64_t invalidations = 0;
+        SST::Cycle_t bankConflictCycles = 0;
+    } stats_;
+};
+
+} // namespace Cinnamon
+} // namespace SST
+
+#endif // _H_SST_CINNAMON_SCRATCHPAD
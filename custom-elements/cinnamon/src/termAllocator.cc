@@ -0,0 +1,108 @@
+// Copyright (c) Siddharth Jayashankar. All rights reserved.
+#include "termAllocator.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace SST {
+namespace Cinnamon {
+
+CinnamonTermAllocator::Placement CinnamonTermAllocator::parsePlacement(const std::string &placement) {
+    if (placement == "sequential") {
+        return Placement::Sequential;
+    }
+    if (placement == "channelInterleaved") {
+        return Placement::ChannelInterleaved;
+    }
+    if (placement == "bankStriped") {
+        return Placement::BankStriped;
+    }
+    throw std::invalid_argument("Unknown term placement " + placement + ". Expected sequential, channelInterleaved or bankStriped");
+}
+
+CinnamonTermAllocator::CinnamonTermAllocator(Placement placement, size_t limbSize, size_t channels, size_t banks, size_t interleaveSize, Addr base) : placement(placement), limbSize(limbSize), channels(channels), banks(banks), interleaveSize(interleaveSize), base(base) {
+    if (limbSize == 0 || channels == 0 || banks == 0 || interleaveSize == 0) {
+        throw std::invalid_argument("Term allocator limb size, channels, banks and interleave size must be non-zero");
+    }
+    // Slots are padded by one alignment unit to leave room for the start offset of the placement
+    auto padded = [&](size_t alignment) {
+        return ((limbSize + alignment - 1) / alignment) * alignment + alignment;
+    };
+    switch (placement) {
+    case Placement::Sequential:
+        slotStride = limbSize;
+        break;
+    case Placement::ChannelInterleaved:
+        slotStride = padded(channels * interleaveSize);
+        break;
+    case Placement::BankStriped:
+        slotStride = padded(channels * interleaveSize * banks);
+        break;
+    }
+}
+
+CinnamonTermAllocator::Addr CinnamonTermAllocator::allocate(uint16_t limbIndex, const std::function<bool(Addr)> &idle) {
+    if (freeSlots.empty() && !quarantine.empty()) {
+        reclaim(idle);
+    }
+    uint64_t s;
+    if (freeSlots.empty()) {
+        s = numSlots++;
+    } else {
+        s = *freeSlots.begin();
+        freeSlots.erase(freeSlots.begin());
+        stats_.reuses++;
+    }
+    stats_.allocations++;
+    stats_.live++;
+    stats_.maxLive = std::max(stats_.maxLive, stats_.live);
+
+    Addr addr = base + s * slotStride;
+    switch (placement) {
+    case Placement::Sequential:
+        break;
+    case Placement::ChannelInterleaved:
+        addr += (s % channels) * interleaveSize;
+        break;
+    case Placement::BankStriped:
+        addr += (limbIndex % banks) * channels * interleaveSize;
+        break;
+    }
+    return addr;
+}
+
+void CinnamonTermAllocator::free(Addr addr) {
+    quarantine.push_back(addr);
+    stats_.frees++;
+    stats_.live--;
+    stats_.maxQuarantined = std::max(stats_.maxQuarantined, quarantine.size());
+}
+
+void CinnamonTermAllocator::reclaim(const std::function<bool(Addr)> &idle) {
+    for (auto it = quarantine.begin(); it != quarantine.end();) {
+        if (idle(*it)) {
+            freeSlots.insert(slot(*it));
+            it = quarantine.erase(it);
+        } else {
+            it++;
+        }
+    }
+}
+
+std::string CinnamonTermAllocator::printStats(const std::string &title) const {
+    static const char *placementNames[] = {"Sequential", "Channel Interleaved", "Bank Striped"};
+    std::stringstream s;
+    s << title << "\n";
+    s << "\tPlacement: " << placementNames[static_cast<int>(placement)] << "\n";
+    s << "\tAllocations: " << stats_.allocations << "\n";
+    s << "\tFrees: " << stats_.frees << "\n";
+    s << "\tReused Slots: " << stats_.reuses << "\n";
+    s << "\tMax Live Terms: " << stats_.maxLive << "\n";
+    s << "\tMax Quarantined Terms: " << stats_.maxQuarantined << "\n";
+    s << "\tFootprint (bytes): " << numSlots * slotStride << "\n";
+    return s.str();
+}
+
+} // namespace Cinnamon
+} // namespace SST
@@ -0,0 +1,77 @@
+// Copyright (c) Siddharth Jayashankar. All rights reserved.
+#ifndef _H_SST_CINNAMON_TERM_ALLOCATOR
+#define _H_SST_CINNAMON_TERM_ALLOCATOR
+
+#include <functional>
+#include <list>
+#include <set>
+#include <string>
+
+#include "sst/core/interfaces/stdMem.h"
+
+namespace SST {
+namespace Cinnamon {
+
+// Assigns memory addresses to the limbs of trace terms.
+// Each term occupies one slot. Freed slots are quarantined until the memory unit has no transfer
+// to them in flight and are then reused, lowest slot first, so the footprint stays bounded.
+// The placement policies assume a memory that stripes addresses over channels in interleaveSize
+// chunks, with consecutive stripes going to consecutive banks (as cinnamon.HBM does):
+//  sequential:         slot i starts at i * limbSize
+//  channelInterleaved: slots start on successive channels so that transfers issued together
+//                      do not all begin on the same channel
+//  bankStriped:        a limb with limb index l starts in bank l % banks of every channel
+class CinnamonTermAllocator {
+public:
+    using Addr = Interfaces::StandardMem::Addr;
+
+    enum class Placement {
+        Sequential,
+        ChannelInterleaved,
+        BankStriped
+    };
+    static Placement parsePlacement(const std::string &placement);
+
+    // Slots are placed from base upwards
+    CinnamonTermAllocator(Placement placement, size_t limbSize, size_t channels, size_t banks, size_t interleaveSize, Addr base = 0);
+
+    // Allocates a slot for a limb with index limbIndex. When no slot is free, quarantined slots
+    // for which idle returns true are reclaimed first
+    Addr allocate(uint16_t limbIndex, const std::function<bool(Addr)> &idle);
+    void free(Addr addr);
+
+    std::string printStats(const std::string &title) const;
+
+private:
+    Placement placement;
+    size_t limbSize;
+    size_t channels;
+    size_t banks;
+    size_t interleaveSize;
+    size_t slotStride;
+    Addr base;
+
+    uint64_t numSlots = 0;
+    std::set<uint64_t> freeSlots;
+    std::list<Addr> quarantine;
+
+    void reclaim(const std::function<bool(Addr)> &idle);
+
+    uint64_t slot(Addr addr) const {
+        return (addr - base) / slotStride;
+    }
+
+    struct Stats {
+        uint64_t allocations = 0;
+        uint64_t frees = 0;
+        uint64_t reuses = 0;
+        uint64_t live = 0;
+        uint64_t maxLive = 0;
+        size_t maxQuarantined = 0;
+    } stats_;
+};
+
+} // namespace Cinnamon
+} // namespace SST
+
+#endif // _H_SST_CINNAMON_TERM_ALLOCATOR
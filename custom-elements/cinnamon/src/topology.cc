@@ -0,0 +1,349 @@
+// Copyright (c) Siddharth Jayashankar. All rights reserved.
+#include "topology.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+namespace SST {
+namespace Cinnamon {
+
+CinnamonTopology::Kind CinnamonTopology::parseKind(const std::string &kind) {
+    if (kind == "ring") {
+        return Kind::Ring;
+    }
+    if (kind == "torus2d") {
+        return Kind::Torus2D;
+    }
+    if (kind == "switch") {
+        return Kind::Switch;
+    }
+    throw std::invalid_argument("Unknown topology " + kind + ". Expected ring, torus2d or switch");
+}
+
+CinnamonTopology::CinnamonTopology(Kind kind, size_t numChips, size_t torusWidth, double psPerByte, SimTime_t hopLatency) : CinnamonTopology(numChips, numChips, LevelConfig{kind, torusWidth, psPerByte, hopLatency}, LevelConfig{}) {}
+
+CinnamonTopology::CinnamonTopology(size_t numChips, size_t chipsPerBoard, const LevelConfig &boardConfig, const LevelConfig &fabricConfig) : numChips(numChips), boardSize(chipsPerBoard) {
+    if (numChips == 0) {
+        throw std::invalid_argument("Topology needs at least one chip");
+    }
+    if (chipsPerBoard == 0 || numChips % chipsPerBoard != 0) {
+        throw std::invalid_argument("Chips per board " + std::to_string(chipsPerBoard) + " does not divide the number of chips " + std::to_string(numChips));
+    }
+    numBoards = numChips / chipsPerBoard;
+    board = makeLevel(boardConfig, chipsPerBoard);
+    fabric = makeLevel(fabricConfig, numBoards);
+
+    numNodes = numChips;
+    for (size_t chip = 0; chip < numChips; chip++) {
+        boardPosition.emplace_back(chip / boardSize, chip % boardSize);
+    }
+    if (board.kind == Kind::Switch) {
+        for (size_t b = 0; b < numBoards; b++) {
+            boardSwitch.push_back(numNodes++);
+            boardPosition.emplace_back(b, boardSize);
+        }
+    }
+    if (numBoards > 1 && fabric.kind == Kind::Switch) {
+        // The fabric switch is not on any board
+        fabricSwitch = numNodes++;
+        boardPosition.emplace_back(numBoards, 0);
+    }
+    build();
+}
+
+CinnamonTopology::Level CinnamonTopology::makeLevel(const LevelConfig &config, size_t size) {
+    Level level{config.kind, size, 1, 1, config.psPerByte, config.hopLatency};
+    if (config.kind == Kind::Torus2D) {
+        level.width = config.torusWidth;
+        if (level.width == 0) {
+            level.width = 1;
+            for (size_t w = 1; w * w <= size; w++) {
+                if (size % w == 0) {
+                    level.width = w;
+                }
+            }
+        }
+        if (size % level.width != 0) {
+            throw std::invalid_argument("Torus width " + std::to_string(level.width) + " does not divide the number of nodes " + std::to_string(size));
+        }
+        level.height = size / level.width;
+    }
+    return level;
+}
+
+template <typename NodeOf>
+void CinnamonTopology::addLevelLinks(const Level &level, NodeOf node, bool fabricLinks) {
+    const size_t size = level.size;
+    for (size_t p = 0; p < size; p++) {
+        switch (level.kind) {
+        case Kind::Ring:
+            if (size > 1) {
+                addLink(node(p), node((p + 1) % size), level, fabricLinks);
+                addLink(node(p), node((p + size - 1) % size), level, fabricLinks);
+            }
+            break;
+        case Kind::Torus2D: {
+            const size_t width = level.width;
+            const size_t height = level.height;
+            size_t x = p % width;
+            size_t y = p / width;
+            if (width > 1) {
+                addLink(node(p), node(y * width + (x + 1) % width), level, fabricLinks);
+                addLink(node(p), node(y * width + (x + width - 1) % width), level, fabricLinks);
+            }
+            if (height > 1) {
+                addLink(node(p), node(((y + 1) % height) * width + x), level, fabricLinks);
+                addLink(node(p), node(((y + height - 1) % height) * width + x), level, fabricLinks);
+            }
+            break;
+        }
+        case Kind::Switch:
+            addLink(node(p), node(size), level, fabricLinks);
+            addLink(node(size), node(p), level, fabricLinks);
+            break;
+        }
+    }
+}
+
+void CinnamonTopology::build() {
+    for (size_t b = 0; b < numBoards; b++) {
+        addLevelLinks(board, [&](size_t position) { return boardNode(b, position); }, false);
+    }
+    if (numBoards > 1) {
+        addLevelLinks(fabric, [&](size_t position) { return fabricNode(position); }, true);
+    }
+
+    reducerBusyUntil.resize(numNodes, 0);
+    routes.resize(numChips, std::vector<std::vector<size_t>>(numChips));
+    for (size_t src = 0; src < numChips; src++) {
+        for (size_t dst = 0; dst < numChips; dst++) {
+            size_t node = src;
+            while (node != dst) {
+                size_t next = nextHop(node, dst);
+                routes[src][dst].push_back(linkIndex.at({node, next}));
+                node = next;
+            }
+        }
+    }
+}
+
+void CinnamonTopology::addLink(size_t from, size_t to, const Level &level, bool fabricLink) {
+    if (linkIndex.emplace(std::make_pair(from, to), links.size()).second) {
+        links.push_back(Link{from, to, level.psPerByte, level.hopLatency, fabricLink});
+    }
+}
+
+size_t CinnamonTopology::boardNode(size_t boardID, size_t position) const {
+    return position < boardSize ? boardID * boardSize + position : boardSwitch[boardID];
+}
+
+size_t CinnamonTopology::fabricNode(size_t position) const {
+    // The gateway of a board is its first chip
+    return position < numBoards ? position * boardSize : fabricSwitch;
+}
+
+size_t CinnamonTopology::ringStep(size_t from, size_t to, size_t size) {
+    size_t distance = (to + size - from) % size;
+    if (distance == 0) {
+        return from;
+    }
+    return (distance <= size / 2) ? (from + 1) % size : (from + size - 1) % size;
+}
+
+size_t CinnamonTopology::levelStep(const Level &level, size_t from, size_t to) {
+    switch (level.kind) {
+    case Kind::Ring:
+        return ringStep(from, to, level.size);
+    case Kind::Torus2D: {
+        size_t x = from % level.width;
+        size_t y = from / level.width;
+        if (x != to % level.width) {
+            x = ringStep(x, to % level.width, level.width);
+        } else {
+            y = ringStep(y, to / level.width, level.height);
+        }
+        return y * level.width + x;
+    }
+    case Kind::Switch:
+        return (from == level.size) ? to : level.size;
+    }
+    return to;
+}
+
+size_t CinnamonTopology::nextHop(size_t node, size_t dst) const {
+    const size_t dstBoard = dst / boardSize;
+    if (numBoards > 1 && fabric.kind == Kind::Switch && node == fabricSwitch) {
+        return fabricNode(levelStep(fabric, numBoards, dstBoard));
+    }
+    auto [nodeBoard, position] = boardPosition[node];
+    if (nodeBoard == dstBoard) {
+        return boardNode(nodeBoard, levelStep(board, position, dst % boardSize));
+    }
+    if (position != 0) {
+        // Towards the gateway of the board
+        return boardNode(nodeBoard, levelStep(board, position, 0));
+    }
+    return fabricNode(levelStep(fabric, nodeBoard, dstBoard));
+}
+
+SimTime_t CinnamonTopology::transfer(size_t src, size_t dst, uint64_t bytes, SimTime_t start) {
+    if (src / boardSize != dst / boardSize) {
+        stats_.fabricTransfers++;
+    }
+    return transferPath(routes[src][dst], bytes, start);
+}
+
+SimTime_t CinnamonTopology::transferPath(const std::vector<size_t> &route, uint64_t bytes, SimTime_t start) {
+    if (route.empty()) {
+        return start;
+    }
+    // Links may differ in bandwidth, so the tail leaves a link no earlier than it arrived over the previous one
+    double head = start;
+    double tail = 0;
+    for (auto l : route) {
+        auto &link = links[l];
+        const double serialization = bytes * link.psPerByte;
+        double begin = std::max(head, link.busyUntil);
+        stats_.contentionTime += begin - head;
+        tail = std::max(begin + serialization, tail);
+        link.busyUntil = tail;
+        link.busyTime += serialization;
+        link.bytes += bytes;
+        link.transfers++;
+        head = begin + link.hopLatency;
+        tail += link.hopLatency;
+    }
+    stats_.transfers++;
+    stats_.hops += route.size();
+    return static_cast<SimTime_t>(std::ceil(tail));
+}
+
+SimTime_t CinnamonTopology::reduceInNetwork(size_t dst, const std::vector<std::pair<size_t, SimTime_t>> &inputs, uint64_t bytes, SimTime_t reduceLatency, double reducePsPerByte) {
+    stats_.inNetworkReductions++;
+    // Partial sums a node combines: its own input and one per child in the tree of routes to dst
+    std::vector<size_t> contributions(numNodes, 0);
+    std::vector<bool> onTree(numNodes, false);
+    std::vector<bool> isSource(numNodes, false);
+    std::vector<size_t> depth(numNodes, 0);
+    std::vector<double> ready(numNodes, 0);
+    for (auto &[chip, time] : inputs) {
+        contributions[chip]++;
+        isSource[chip] = true;
+        ready[chip] = std::max(ready[chip], double(time));
+        size_t node = chip;
+        while (node != dst && !onTree[node]) {
+            onTree[node] = true;
+            size_t next = nextHop(node, dst);
+            contributions[next]++;
+            node = next;
+        }
+    }
+    onTree[dst] = true;
+    std::vector<size_t> nodes;
+    for (size_t node = 0; node < numNodes; node++) {
+        if (onTree[node]) {
+            for (size_t n = node; n != dst; n = nextHop(n, dst)) {
+                depth[node]++;
+            }
+            nodes.push_back(node);
+        }
+    }
+    // Children are complete before their parents
+    std::sort(nodes.begin(), nodes.end(), [&](size_t a, size_t b) { return depth[a] > depth[b]; });
+
+    const double reduceTime = reduceLatency + bytes * reducePsPerByte;
+    for (auto node : nodes) {
+        if (node != dst && !isSource[node] && contributions[node] == 1) {
+            continue; // Crossed cut-through by the path of its child
+        }
+        if (contributions[node] > 1) {
+            double begin = std::max(ready[node], reducerBusyUntil[node]);
+            stats_.reducerWaitTime += begin - ready[node];
+            reducerBusyUntil[node] = begin + reduceTime;
+            stats_.reducerBusyTime += reduceTime;
+            stats_.combines += contributions[node] - 1;
+            ready[node] = begin + reduceTime;
+        }
+        if (node == dst) {
+            break;
+        }
+        // Nodes that only pass the value on are crossed cut-through up to the next node that combines
+        std::vector<size_t> path;
+        size_t next = node;
+        do {
+            size_t hop = nextHop(next, dst);
+            path.push_back(linkIndex.at({next, hop}));
+            next = hop;
+        } while (next != dst && contributions[next] == 1);
+        ready[next] = std::max(ready[next], double(transferPath(path, bytes, static_cast<SimTime_t>(std::ceil(ready[node])))));
+    }
+    return static_cast<SimTime_t>(std::ceil(ready[dst]));
+}
+
+std::string CinnamonTopology::printStats(SimTime_t elapsed) const {
+    static const char *kindNames[] = {"Ring", "2D Torus", "Switch"};
+    auto levelName = [](const Level &level) {
+        std::string name = kindNames[static_cast<int>(level.kind)];
+        if (level.kind == Kind::Torus2D) {
+            name += " (" + std::to_string(level.width) + " x " + std::to_string(level.height) + ")";
+        }
+        return name;
+    };
+    std::stringstream s;
+    s << "Topology\n";
+    if (numBoards > 1) {
+        s << "\tBoards: " << numBoards << " x " << boardSize << " chips\n";
+        s << "\tBoard Kind: " << levelName(board) << "\n";
+        s << "\tFabric Kind: " << levelName(fabric) << "\n";
+    } else {
+        s << "\tKind: " << levelName(board) << "\n";
+    }
+    s << "\tLinks: " << links.size() << "\n";
+    s << "\tTransfers: " << stats_.transfers << "\n";
+    if (numBoards > 1) {
+        s << "\tInter-Board Transfers: " << stats_.fabricTransfers << "\n";
+    }
+    s << "\tAverage Hops: " << (stats_.transfers ? double(stats_.hops) / stats_.transfers : 0.0) << "\n";
+    s << "\tLink Contention Time (ps): " << stats_.contentionTime << "\n";
+    if (numBoards > 1) {
+        s << printLinkStats("Board ", false, elapsed);
+        s << printLinkStats("Fabric ", true, elapsed);
+    } else {
+        s << printLinkStats("", false, elapsed);
+    }
+    if (stats_.inNetworkReductions) {
+        s << "\tIn-Network Reductions: " << stats_.inNetworkReductions << "\n";
+        s << "\tPartial Sums Combined In Network: " << stats_.combines << "\n";
+        s << "\tReducer Busy Time (ps): " << stats_.reducerBusyTime << "\n";
+        s << "\tReducer Wait Time (ps): " << stats_.reducerWaitTime << "\n";
+    }
+    return s.str();
+}
+
+std::string CinnamonTopology::printLinkStats(const std::string &prefix, bool fabricLinks, SimTime_t elapsed) const {
+    size_t count = 0;
+    uint64_t bytes = 0;
+    double busy = 0;
+    double maxBusy = 0;
+    for (auto &link : links) {
+        if (link.fabric != fabricLinks) {
+            continue;
+        }
+        count++;
+        bytes += link.bytes;
+        busy += link.busyTime;
+        maxBusy = std::max(maxBusy, link.busyTime);
+    }
+    std::stringstream s;
+    s << "\t" << prefix << "Bytes Over Links: " << bytes << "\n";
+    if (elapsed > 0 && count) {
+        s << "\tAverage " << prefix << "Link Utilisation %: " << (100.0 * busy) / (elapsed * count) << "\n";
+        s << "\tMax " << prefix << "Link Utilisation %: " << (100.0 * maxBusy) / elapsed << "\n";
+    }
+    return s.str();
+}
+
+} // namespace Cinnamon
+} // namespace SST
@@ -0,0 +1,146 @@
+// Copyright (c) Siddharth Jayashankar. All rights reserved.
+#ifndef _H_SST_CINNAMON_TOPOLOGY
+#define _H_SST_CINNAMON_TOPOLOGY
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sst/core/sst_types.h"
+
+namespace SST {
+namespace Cinnamon {
+
+// Links between chips and the routes transfers take over them.
+// Every link is unidirectional with its own bandwidth and occupancy, so transfers that share a link
+// queue behind each other. Transfers are cut-through: the head advances one hop latency per link
+// once the link is free and the tail follows one serialization time behind it.
+//  ring:    chips form a bidirectional ring. Transfers take the shorter direction
+//  torus2d: chips form a width x (numChips / width) torus with wraparound links in both dimensions.
+//           Transfers are routed along the row first and then along the column
+//  switch:  every chip has an uplink to and a downlink from a full bisection switch
+// A hierarchical topology groups the chips into boards of consecutive chips. The chips of a board are connected
+// by the board interconnect and the first chip of every board is its gateway to the inter-board fabric, which
+// connects the gateways. Transfers between boards travel to the gateway, across the fabric and from the
+// gateway of the destination board. Each level has its own kind, bandwidth and hop latency
+class CinnamonTopology {
+public:
+    enum class Kind {
+        Ring,
+        Torus2D,
+        Switch
+    };
+    static Kind parseKind(const std::string &kind);
+
+    struct LevelConfig {
+        Kind kind = Kind::Ring;
+        size_t torusWidth = 0; // 0 picks the largest divisor of the level size that is at most its square root
+        double psPerByte = 1;
+        SimTime_t hopLatency = 0;
+    };
+
+    CinnamonTopology(Kind kind, size_t numChips, size_t torusWidth, double psPerByte, SimTime_t hopLatency);
+    CinnamonTopology(size_t numChips, size_t chipsPerBoard, const LevelConfig &boardConfig, const LevelConfig &fabricConfig);
+
+    // Reserves the links from src to dst for a transfer of bytes that can start at time start (in ps).
+    // Returns the time the last byte arrives at dst
+    SimTime_t transfer(size_t src, size_t dst, uint64_t bytes, SimTime_t start);
+
+    // Reduces the inputs (chip, time the input is available) into dst inside the network. The routes of the inputs
+    // to dst form a tree, and every node where two or more partial sums meet (a switch or an intermediate chip)
+    // combines them and forwards a single value. A node reduces one value at a time, taking reduceLatency
+    // plus reducePsPerByte per byte. Returns the time the reduced value is complete at dst
+    SimTime_t reduceInNetwork(size_t dst, const std::vector<std::pair<size_t, SimTime_t>> &inputs, uint64_t bytes, SimTime_t reduceLatency, double reducePsPerByte);
+
+    size_t hops(size_t src, size_t dst) const {
+        return routes[src][dst].size();
+    }
+
+    size_t numLinks() const {
+        return links.size();
+    }
+
+    size_t chipsPerBoard() const {
+        return boardSize;
+    }
+
+    // elapsed is the time over which link utilisation is reported
+    std::string printStats(SimTime_t elapsed) const;
+
+private:
+    struct Link {
+        size_t from;
+        size_t to;
+        double psPerByte;
+        SimTime_t hopLatency;
+        bool fabric;
+        double busyUntil = 0;
+        double busyTime = 0;
+        uint64_t bytes = 0;
+        uint64_t transfers = 0;
+    };
+
+    // One level of the hierarchy. Positions 0 to size - 1 are its members and position size is its switch
+    struct Level {
+        Kind kind = Kind::Ring;
+        size_t size = 0;
+        size_t width = 1;
+        size_t height = 1;
+        double psPerByte = 1;
+        SimTime_t hopLatency = 0;
+    };
+
+    size_t numChips;
+    size_t boardSize;
+    size_t numBoards;
+    Level board;
+    Level fabric;
+    // Switch node of every board and of the fabric. Chips are nodes 0 to numChips - 1
+    std::vector<size_t> boardSwitch;
+    size_t fabricSwitch = 0;
+    size_t numNodes;
+    // Board and position within the board of every node
+    std::vector<std::pair<size_t, size_t>> boardPosition;
+
+    std::vector<Link> links;
+    std::map<std::pair<size_t, size_t>, size_t> linkIndex;
+    // Links crossed by a transfer from a chip to another, in order
+    std::vector<std::vector<std::vector<size_t>>> routes;
+    // Time until which the reduction unit of each node is busy
+    std::vector<double> reducerBusyUntil;
+
+    static Level makeLevel(const LevelConfig &config, size_t size);
+    void build();
+    void addLink(size_t from, size_t to, const Level &level, bool fabricLink);
+    // Adds the links of a level whose position p is node(p)
+    template <typename NodeOf>
+    void addLevelLinks(const Level &level, NodeOf node, bool fabricLinks);
+    size_t boardNode(size_t boardID, size_t position) const;
+    size_t fabricNode(size_t position) const;
+    // Node a transfer to dst moves to next from node
+    size_t nextHop(size_t node, size_t dst) const;
+    // Position a transfer within a level moves to next from position from towards position to
+    static size_t levelStep(const Level &level, size_t from, size_t to);
+    // Step of one along a ring of size nodes from position from towards position to, taking the shorter direction
+    static size_t ringStep(size_t from, size_t to, size_t size);
+    // Reserves the given links for a cut-through transfer. Returns the time the last byte arrives
+    SimTime_t transferPath(const std::vector<size_t> &path, uint64_t bytes, SimTime_t start);
+    std::string printLinkStats(const std::string &prefix, bool fabricLinks, SimTime_t elapsed) const;
+
+    struct Stats {
+        uint64_t transfers = 0;
+        uint64_t hops = 0;
+        uint64_t fabricTransfers = 0;
+        double contentionTime = 0;
+        uint64_t inNetworkReductions = 0;
+        uint64_t combines = 0;
+        double reducerBusyTime = 0;
+        double reducerWaitTime = 0;
+    } stats_;
+};
+
+} // namespace Cinnamon
+} // namespace SST
+
+#endif // _H_SST_CINNAMON_TOPOLOGY
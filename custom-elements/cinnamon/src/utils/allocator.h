@@ -2,6 +2,8 @@
 #ifndef _H_CINNAMON_ALLOCATOR_
 #define _H_CINNAMON_ALLOCATOR_
 
+#include <cstddef>
+#include <cstdint>
 #include <stdexcept>
 #include <vector>
 
@@ -20,23 +22,41 @@ public:
     }
 
     uint32_t allocate() {
-        auto freeIndex = mAlloc;
-        mAlloc = table[mAlloc];
-        if (freeIndex >= numObjects) {
+        if (full()) {
             throw std::runtime_error("Allocation Failed. No free space available");
         }
+        auto freeIndex = mAlloc;
+        mAlloc = table[mAlloc];
+        numAllocated++;
         return freeIndex;
     }
 
     void deallocate(uint32_t index) {
+        if (index >= numObjects) {
+            throw std::out_of_range("Deallocation of an index outside the pool");
+        }
         table[index] = mAlloc;
         mAlloc = index;
+        numAllocated--;
+    }
+
+    bool full() const {
+        return mAlloc >= numObjects;
+    }
+
+    size_t allocated() const {
+        return numAllocated;
+    }
+
+    size_t capacity() const {
+        return numObjects;
     }
 
 private:
     size_t numObjects = 0;
+    size_t numAllocated = 0;
     std::vector<uint32_t> table;
-    uint32_t mAlloc;
+    uint32_t mAlloc = 0;
 };
 
 } // namespace Utils
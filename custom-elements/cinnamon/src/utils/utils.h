@@ -3,6 +3,7 @@
 #define _H_SST_CINNAMON_UTILS
 
 #include "sst/core/sst_config.h"
+#include <functional>
 #include <iostream>
 #include <set>
 #include <sstream>
@@ -12,6 +13,12 @@ namespace SST {
 namespace Cinnamon {
 namespace Utils {
 
+// Mixes the hash of val into seed (same mixing function as boost::hash_combine)
+template <typename T>
+inline void hashCombine(std::uint64_t &seed, const T &val) {
+    seed ^= std::hash<T>{}(val) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+}
+
 template <typename T>
 class DisjointIntervalSet;
 
@@ -156,6 +163,13 @@ public:
         return *intervals.begin();
     }
 
+    Interval<T> back() const {
+        if (intervals.empty()) {
+            throw std::invalid_argument("");
+        }
+        return *intervals.rbegin();
+    }
+
     void popFront() {
         if (intervals.empty()) {
             throw std::invalid_argument("");
@@ -0,0 +1,28 @@
+# Copyright (c) Siddharth Jayashankar. All rights reserved.
+# One chip backed by cinnamon.HBM with a single MSHR, so queued loads and stores compete for it
+# Usage: sst memoryArbitration.py --model-options="<trace> <memoryArbitration> <freeRegisterWatermark>"
+import sys
+import sst
+
+trace, arbitration, watermark = sys.argv[1], sys.argv[2], sys.argv[3]
+
+accelerator = sst.Component("accelerator", "cinnamon.Accelerator")
+accelerator.addParams({"clock": "1GHz", "num_chips": 1})
+
+network = accelerator.setSubComponent("network", "cinnamon.Network")
+
+chip = accelerator.setSubComponent("chip_0", "cinnamon.Chip")
+chip.addParams({
+    "verbose": 4,
+    "numVectorRegs": 8,
+    "numMSHRs": 1,
+    "memoryArbitration": arbitration,
+    "freeRegisterWatermark": watermark,
+})
+reader = chip.setSubComponent("reader", "cinnamon.CinnamonTextTraceReader")
+reader.addParams({"file": trace})
+memory = chip.setSubComponent("memory", "cinnamon.HBM")
+memory.addParams({"baseLatency": "100ns"})
+
+link = sst.Link("chip_0_network")
+link.connect((chip, "cinnamon_network_port", "1ns"), (network, "chip_port_0", "1ns"))
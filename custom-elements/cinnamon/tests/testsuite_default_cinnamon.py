@@ -0,0 +1,51 @@
+# -*- coding: utf-8 -*-
+# Copyright (c) Siddharth Jayashankar. All rights reserved.
+import os
+
+from sst_unittest import *
+from sst_unittest_support import *
+
+
+class testcase_cinnamon(SSTTestCase):
+
+    def setUp(self):
+        super(type(self), self).setUp()
+
+    def tearDown(self):
+        super(type(self), self).tearDown()
+
+    # While the first load holds the only MSHR, the load of r1 and the store of r0 queue behind it.
+    # Nothing reads r1, so under register pressure deadline issues the store first
+    def test_deadline_store_beats_unconsumed_load(self):
+        order = self._issue_order("deadline", 1000)
+        self.assertLess(order.index("Store"), order.index("LoadV", 1))
+
+    # Without register pressure deadline issues loads first, like loadsFirst
+    def test_deadline_load_first_without_pressure(self):
+        order = self._issue_order("deadline", 0)
+        self.assertLess(order.index("LoadV", 1), order.index("Store"))
+
+    def test_loads_first(self):
+        order = self._issue_order("loadsFirst", 1000)
+        self.assertLess(order.index("LoadV", 1), order.index("Store"))
+
+    # Opcodes of the memory instructions in the order the memory unit issued them
+    def _issue_order(self, arbitration, watermark):
+        testsuitedir = self.get_testsuite_dir()
+        outdir = self.get_test_output_run_dir()
+        name = "memoryArbitration_{0}_{1}".format(arbitration, watermark)
+        sdlfile = "{0}/memoryArbitration.py".format(testsuitedir)
+        tracefile = "{0}/deadline.trace".format(testsuitedir)
+        outfile = "{0}/{1}.out".format(outdir, name)
+        options = "--model-options=\"{0} {1} {2}\"".format(tracefile, arbitration, watermark)
+
+        self.run_sst(sdlfile, outfile, other_args=options)
+
+        order = []
+        with open(outfile) as out:
+            for line in out:
+                pos = line.find("Issuing Instruction: ")
+                if pos != -1:
+                    order.append(line[pos:].split()[2])
+        self.assertEqual(len(order), 3, "Expected three memory instructions in {0}".format(outfile))
+        return order